@@ -0,0 +1,24 @@
+################################################################################
+# Build
+################################################################################
+
+# Checks the processor-specific paths in `../src/bytes.cpp` against the plain
+# versions, and times them.  `make check` builds and runs it.
+
+isEmpty(BUILDDIR) {
+    BUILDDIR = ../build
+}
+isEmpty(MAKEDIR) {
+    MAKEDIR = ../make
+}
+
+CONFIG += console testcase no_testcase_installs warn_on
+CONFIG -= app_bundle
+DESTDIR = $${BUILDDIR}/bench
+HEADERS += ../src/bytes.h
+OBJECTS_DIR = $${MAKEDIR}/bench
+QT = core
+SOURCES += ../src/bytes.cpp \
+    bytesbench.cpp
+TARGET = bytesbench
+TEMPLATE = app
@@ -0,0 +1,192 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+// Checks every path of the routines in `bytes.h` that the build and the
+// processor support against plain byte-at-a-time versions, and then times
+// them.  The program exits with a failure status if any path disagrees with
+// the plain version.
+
+#include <cstdlib>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTextStream>
+#include <QtCore/QVector>
+
+#include "../src/bytes.h"
+
+// Static data
+
+static const char *pathNames[BYTESPATH_TOTAL] = {"portable", "sse2", "avx2"};
+
+static const char hexDigits[] = "0123456789abcdef";
+
+// Bytes are checked at every length up to this one, and at every status byte
+// position within each length.
+static const int CHECK_LENGTH = 300;
+
+// The time each path is timed for.
+static const qint64 TIME_MS = 250;
+
+// Static functions
+
+static bool
+checkContainsStatusByte(BytesPath path, QTextStream &out)
+{
+    // The buffer is filled with status bytes past the end of the data, so
+    // reading too far gives the wrong answer.
+    QVector<quint8> buffer(CHECK_LENGTH + 64);
+    for (int offset = 0; offset < 2; offset++) {
+        quint8 *data = buffer.data() + offset;
+        for (int length = 0; length <= CHECK_LENGTH; length++) {
+            buffer.fill(0xff);
+            for (int i = 0; i < length; i++) {
+                data[i] = static_cast<quint8>(std::rand() & 0x7f);
+            }
+
+            // `position == length` checks the message without a status byte.
+            for (int position = 0; position <= length; position++) {
+                if (position < length) {
+                    data[position] |= 0x80;
+                }
+                bool expected = position < length;
+                if (containsStatusByte(data, length, path) != expected) {
+                    out << "containsStatusByte (" << pathNames[path]
+                        << "): wrong result for length " << length
+                        << ", status byte at " << position << ", offset "
+                        << offset << "\n";
+                    return false;
+                }
+                if (position < length) {
+                    data[position] &= 0x7f;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static bool
+checkWriteHexString(BytesPath path, QTextStream &out)
+{
+    // The characters past the end of the string are checked, so that
+    // writing too far is caught too.
+    const ushort guard = 0xfffe;
+    QVector<quint8> buffer(CHECK_LENGTH + 1);
+    QVector<ushort> expected(getHexStringLength(CHECK_LENGTH) + 32);
+    QVector<QChar> result(expected.count());
+    for (int offset = 0; offset < 2; offset++) {
+        const quint8 *data = buffer.constData() + offset;
+        for (int length = 0; length <= CHECK_LENGTH - offset; length++) {
+            for (int i = 0; i < buffer.count(); i++) {
+                buffer[i] = static_cast<quint8>(std::rand() & 0xff);
+            }
+            expected.fill(guard);
+            ushort *e = expected.data();
+            for (int i = 0; i < length; i++) {
+                *e++ = hexDigits[data[i] >> 4];
+                *e++ = hexDigits[data[i] & 0xf];
+                if (i + 1 < length) {
+                    *e++ = ' ';
+                }
+            }
+            result.fill(QChar(guard));
+            writeHexString(data, length, result.data(), path);
+            for (int i = 0; i < result.count(); i++) {
+                if (result[i].unicode() != expected[i]) {
+                    out << "writeHexString (" << pathNames[path]
+                        << "): wrong character " << i << " for length "
+                        << length << ", offset " << offset << "\n";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static void
+timeContainsStatusByte(BytesPath path, QTextStream &out)
+{
+    // Message without a status byte, so that every byte is looked at.
+    QVector<quint8> data(1 << 20);
+    for (int i = 0; i < data.count(); i++) {
+        data[i] = static_cast<quint8>(i & 0x7f);
+    }
+    QElapsedTimer timer;
+    qint64 bytes = 0;
+    int found = 0;
+    timer.start();
+    do {
+        found += containsStatusByte(data.constData(), data.count(), path);
+        bytes += data.count();
+    } while (timer.elapsed() < TIME_MS);
+    qint64 elapsed = timer.nsecsElapsed();
+    out << "containsStatusByte (" << pathNames[path] << "): "
+        << ((bytes * 1000.0) / elapsed) << " MB/s";
+    if (found) {
+        out << " (wrong result)";
+    }
+    out << "\n";
+}
+
+static void
+timeWriteHexString(BytesPath path, QTextStream &out)
+{
+    QVector<quint8> data(1 << 16);
+    for (int i = 0; i < data.count(); i++) {
+        data[i] = static_cast<quint8>(std::rand() & 0xff);
+    }
+    QVector<QChar> result(getHexStringLength(data.count()));
+    QElapsedTimer timer;
+    qint64 bytes = 0;
+    timer.start();
+    do {
+        writeHexString(data.constData(), data.count(), result.data(), path);
+        bytes += data.count();
+    } while (timer.elapsed() < TIME_MS);
+    qint64 elapsed = timer.nsecsElapsed();
+    out << "writeHexString (" << pathNames[path] << "): "
+        << ((bytes * 1000.0) / elapsed) << " MB/s\n";
+}
+
+// Entry point
+
+int
+main(int /*argc*/, char **/*argv*/)
+{
+    QTextStream out(stdout);
+    bool passed = true;
+    std::srand(1);
+    for (int i = 0; i < BYTESPATH_TOTAL; i++) {
+        BytesPath path = static_cast<BytesPath>(i);
+        if (! isBytesPathSupported(path)) {
+            out << pathNames[path] << ": not supported\n";
+            continue;
+        }
+        if (checkContainsStatusByte(path, out) &&
+            checkWriteHexString(path, out)) {
+            out << pathNames[path] << ": matches the plain versions\n";
+            timeContainsStatusByte(path, out);
+            timeWriteHexString(path, out);
+        } else {
+            passed = false;
+        }
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
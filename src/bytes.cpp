@@ -0,0 +1,298 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "bytes.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define MIDISNOOP_SSE2
+#include <emmintrin.h>
+
+// AVX2 code is compiled with function-level target attributes, so the rest
+// of the program doesn't have to be built for processors that support AVX2.
+#if defined(__GNUC__) && ((__GNUC__ >= 5) || defined(__clang__))
+#define MIDISNOOP_AVX2
+#define MIDISNOOP_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+#endif
+
+// Static data
+
+static const char hexDigits[] = "0123456789abcdef";
+
+// Static functions
+
+// Each of the following returns the number of leading bytes it handled, and
+// the caller handles the rest.  The `findStatusByte` functions stop at the
+// first block that contains a status byte, and leave the search within the
+// block to the caller.
+
+static quint32
+findStatusBytePortable(const quint8 *data, quint32 length)
+{
+    // Eight bytes at a time.
+    const quint64 highBits = Q_UINT64_C(0x8080808080808080);
+    quint32 i = 0;
+    for (; (i + 8) <= length; i += 8) {
+        quint64 word;
+        std::memcpy(&word, data + i, 8);
+        if (word & highBits) {
+            break;
+        }
+    }
+    return i;
+}
+
+#ifdef MIDISNOOP_SSE2
+
+static quint32
+findStatusByteSSE2(const quint8 *data, quint32 length)
+{
+    quint32 i = 0;
+    for (; (i + 64) <= length; i += 64) {
+        const __m128i *block = reinterpret_cast<const __m128i *>(data + i);
+        __m128i bits =
+            _mm_or_si128(_mm_or_si128(_mm_loadu_si128(block),
+                                      _mm_loadu_si128(block + 1)),
+                         _mm_or_si128(_mm_loadu_si128(block + 2),
+                                      _mm_loadu_si128(block + 3)));
+        if (_mm_movemask_epi8(bits)) {
+            break;
+        }
+    }
+    for (; (i + 16) <= length; i += 16) {
+        __m128i bits =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        if (_mm_movemask_epi8(bits)) {
+            break;
+        }
+    }
+    return i;
+}
+
+// Writes the two 'hh ' triples held in the halves of `triples` to `out`.
+// Each half also holds a zero character, which is overwritten by the next
+// triple.
+static inline void
+storeHexTriples(__m128i triples, ushort *out)
+{
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out), triples);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out + 3),
+                     _mm_srli_si128(triples, 8));
+}
+
+static inline __m128i
+toHexDigitsSSE2(__m128i nibbles)
+{
+    // '0' + n, plus the distance between '9' + 1 and 'a' when n > 9.
+    __m128i letters = _mm_cmpgt_epi16(nibbles, _mm_set1_epi16(9));
+    return _mm_add_epi16(_mm_add_epi16(nibbles, _mm_set1_epi16('0')),
+                         _mm_and_si128(letters,
+                                       _mm_set1_epi16('a' - '0' - 10)));
+}
+
+static int
+writeHexStringSSE2(const quint8 *data, int length, ushort *out)
+{
+    const __m128i lowNibble = _mm_set1_epi16(0xf);
+    const __m128i spaces = _mm_set1_epi32(' ');
+    const __m128i zero = _mm_setzero_si128();
+
+    // The last triple of every block writes a zero character past its end,
+    // so there must be at least one byte after the block.
+    int i = 0;
+    for (; (i + 8) < length; i += 8) {
+        __m128i bytes =
+            _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>
+                                              (data + i)), zero);
+        __m128i high = toHexDigitsSSE2(_mm_srli_epi16(bytes, 4));
+        __m128i low = toHexDigitsSSE2(_mm_and_si128(bytes, lowNibble));
+        __m128i pairs = _mm_unpacklo_epi16(high, low);
+        ushort *o = out + (i * 3);
+        storeHexTriples(_mm_unpacklo_epi32(pairs, spaces), o);
+        storeHexTriples(_mm_unpackhi_epi32(pairs, spaces), o + 6);
+        pairs = _mm_unpackhi_epi16(high, low);
+        storeHexTriples(_mm_unpacklo_epi32(pairs, spaces), o + 12);
+        storeHexTriples(_mm_unpackhi_epi32(pairs, spaces), o + 18);
+    }
+    return i;
+}
+
+#endif
+
+#ifdef MIDISNOOP_AVX2
+
+MIDISNOOP_TARGET_AVX2 static quint32
+findStatusByteAVX2(const quint8 *data, quint32 length)
+{
+    quint32 i = 0;
+    for (; (i + 128) <= length; i += 128) {
+        const __m256i *block = reinterpret_cast<const __m256i *>(data + i);
+        __m256i bits =
+            _mm256_or_si256(_mm256_or_si256(_mm256_loadu_si256(block),
+                                            _mm256_loadu_si256(block + 1)),
+                            _mm256_or_si256(_mm256_loadu_si256(block + 2),
+                                            _mm256_loadu_si256(block + 3)));
+        if (_mm256_movemask_epi8(bits)) {
+            break;
+        }
+    }
+    for (; (i + 32) <= length; i += 32) {
+        __m256i bits =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        if (_mm256_movemask_epi8(bits)) {
+            break;
+        }
+    }
+    return i;
+}
+
+#endif
+
+typedef quint32 (*FindStatusByteFunction)(const quint8 *, quint32);
+
+#ifdef MIDISNOOP_AVX2
+
+static bool
+hasAVX2()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+static FindStatusByteFunction
+getFindStatusByte(BytesPath path)
+{
+    assert(isBytesPathSupported(path));
+
+#ifdef MIDISNOOP_AVX2
+    if (path == BYTESPATH_AVX2) {
+        return findStatusByteAVX2;
+    }
+#endif
+
+#ifdef MIDISNOOP_SSE2
+    if (path != BYTESPATH_PORTABLE) {
+        return findStatusByteSSE2;
+    }
+#endif
+
+    return findStatusBytePortable;
+}
+
+static BytesPath
+selectBytesPath()
+{
+    for (int i = BYTESPATH_TOTAL - 1; i > BYTESPATH_PORTABLE; i--) {
+        BytesPath path = static_cast<BytesPath>(i);
+        if (isBytesPathSupported(path)) {
+            return path;
+        }
+    }
+    return BYTESPATH_PORTABLE;
+}
+
+// Functions
+
+bool
+containsStatusByte(const quint8 *data, quint32 length)
+{
+    static const FindStatusByteFunction findStatusByte =
+        getFindStatusByte(selectBytesPath());
+    for (quint32 i = findStatusByte(data, length); i < length; i++) {
+        if (data[i] & 0x80) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+containsStatusByte(const quint8 *data, quint32 length, BytesPath path)
+{
+    for (quint32 i = getFindStatusByte(path)(data, length); i < length;
+         i++) {
+        if (data[i] & 0x80) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+isBytesPathSupported(BytesPath path)
+{
+    switch (path) {
+    case BYTESPATH_PORTABLE:
+        return true;
+
+#ifdef MIDISNOOP_SSE2
+    case BYTESPATH_SSE2:
+        return true;
+#endif
+
+#ifdef MIDISNOOP_AVX2
+    case BYTESPATH_AVX2:
+        return hasAVX2();
+#endif
+
+    default:
+        ;
+    }
+    return false;
+}
+
+void
+writeHexString(const quint8 *data, int length, QChar *out)
+{
+    static const BytesPath path = selectBytesPath();
+    writeHexString(data, length, out, path);
+}
+
+void
+writeHexString(const quint8 *data, int length, QChar *out, BytesPath path)
+{
+    assert(isBytesPathSupported(path));
+    ushort *o = reinterpret_cast<ushort *>(out);
+    int i = 0;
+
+#ifdef MIDISNOOP_SSE2
+    if (path != BYTESPATH_PORTABLE) {
+        i = writeHexStringSSE2(data, length, o);
+    }
+#else
+    Q_UNUSED(path);
+#endif
+
+    for (o += i * 3; i < length; i++) {
+        quint8 byte = data[i];
+        *o++ = hexDigits[byte >> 4];
+        *o++ = hexDigits[byte & 0xf];
+        if (i + 1 < length) {
+            *o++ = ' ';
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __BYTES_H__
+#define __BYTES_H__
+
+#include <QtCore/QChar>
+
+// Routines that run over the data bytes of messages, which can be megabytes
+// long in the case of system exclusive messages.  On x86 processors, they use
+// SSE2, and the status byte search uses AVX2 when the processor supports it.
+// Other processors get portable versions.
+
+// The versions of the routines.  The routines that don't take a path use the
+// fastest one the processor supports; the others are there so that the paths
+// can be checked against each other (see `bench/bytesbench.cpp`).  A routine
+// that doesn't have a version for a path uses the next slower one.
+enum BytesPath {
+    BYTESPATH_PORTABLE = 0,
+    BYTESPATH_SSE2 = 1,
+    BYTESPATH_AVX2 = 2,
+
+    BYTESPATH_TOTAL = 3
+};
+
+// Returns true if any of the bytes in `data` has its high bit set (in other
+// words, if any of them is a status byte).
+bool
+containsStatusByte(const quint8 *data, quint32 length);
+
+// `path` must be supported.
+bool
+containsStatusByte(const quint8 *data, quint32 length, BytesPath path);
+
+// Returns the number of characters `writeHexString` writes for `length`
+// bytes.
+inline int
+getHexStringLength(int length)
+{
+    return length ? (length * 3) - 1 : 0;
+}
+
+// Returns true if this build has the path, and the processor can run it.
+bool
+isBytesPathSupported(BytesPath path);
+
+// Writes `data` to `out` as space-separated, lowercase hexadecimal bytes.
+// `out` must have room for `getHexStringLength(length)` characters.
+void
+writeHexString(const quint8 *data, int length, QChar *out);
+
+// `path` must be supported.
+void
+writeHexString(const quint8 *data, int length, QChar *out, BytesPath path);
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cmath>
+
+#include <QtCore/QCoreApplication>
+
+#include "captureclock.h"
+#include "error.h"
+
+#ifdef MIDISNOOP_PLATFORM_UNIX
+#include <cerrno>
+#include <cstring>
+#include <time.h>
+#else
+#include <QtCore/QDateTime>
+#endif
+
+// Static data
+
+// The largest difference, in microseconds, allowed between a timestamp
+// derived from RtMidi's delta times and the time at which the message is
+// actually handled.
+static const quint64 maximumReceiveDrift = 2000;
+
+// Class definition
+
+CaptureClock::CaptureClock()
+{
+
+#ifdef MIDISNOOP_PLATFORM_UNIX
+    struct timespec time;
+    if (clock_gettime(CLOCK_REALTIME, &time) == -1) {
+        throw Error(qApp->translate("CaptureClock",
+                                    "failed to get real time: %1").
+                    arg(strerror(errno)));
+    }
+    quint64 wallTime = (static_cast<quint64>(time.tv_sec) * 1000000) +
+        (static_cast<quint64>(time.tv_nsec) / 1000);
+#else
+    timer.start();
+    quint64 wallTime =
+        static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()) * 1000;
+#endif
+
+    epochOffset = wallTime - getMonotonicTime();
+}
+
+CaptureClock::~CaptureClock()
+{
+    // Empty
+}
+
+quint64
+CaptureClock::getMonotonicTime() const
+{
+
+#ifdef MIDISNOOP_PLATFORM_UNIX
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (static_cast<quint64>(time.tv_sec) * 1000000) +
+        (static_cast<quint64>(time.tv_nsec) / 1000);
+#else
+    return static_cast<quint64>(timer.nsecsElapsed()) / 1000;
+#endif
+
+}
+
+quint64
+CaptureClock::getReceiveTime(double deltaTime, quint64 previousTime) const
+{
+    quint64 now = getTime();
+    if ((! previousTime) || (deltaTime < 0.0)) {
+        return now;
+    }
+
+    // RtMidi's delta times come from the driver's own event timestamps, so
+    // they aren't affected by the delay between the arrival of a message and
+    // the invocation of our callback.  They do accumulate rounding error,
+    // though, so the clock is used instead whenever the two disagree by too
+    // much.
+    quint64 time = previousTime +
+        static_cast<quint64>(std::floor((deltaTime * 1000000.0) + 0.5));
+    if ((time > now) || ((now - time) > maximumReceiveDrift)) {
+        return now;
+    }
+    return time;
+}
+
+quint64
+CaptureClock::getTime() const
+{
+    return epochOffset + getMonotonicTime();
+}
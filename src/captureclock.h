@@ -0,0 +1,65 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __CAPTURECLOCK_H__
+#define __CAPTURECLOCK_H__
+
+#include <QtCore/QtGlobal>
+
+#ifndef MIDISNOOP_PLATFORM_UNIX
+#include <QtCore/QElapsedTimer>
+#endif
+
+// Produces timestamps, in microseconds since the epoch, for sent and received
+// messages.  Timestamps come from a monotonic clock that is anchored to the
+// wall clock once, when the clock is created, so changes to the system time
+// don't affect them.
+
+class CaptureClock {
+
+public:
+
+    CaptureClock();
+
+    ~CaptureClock();
+
+    // Returns the timestamp for a received message, given the delta time
+    // reported by RtMidi and the timestamp of the previous message received
+    // on the same port (or 0 if this is the first message).  This function
+    // is safe to call from the MIDI driver's thread.
+    quint64
+    getReceiveTime(double deltaTime, quint64 previousTime) const;
+
+    quint64
+    getTime() const;
+
+private:
+
+    quint64
+    getMonotonicTime() const;
+
+    quint64 epochOffset;
+
+#ifndef MIDISNOOP_PLATFORM_UNIX
+    QElapsedTimer timer;
+#endif
+
+};
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QStringList>
+#include <QtCore/QtEndian>
+
+#include "capturefile.h"
+#include "error.h"
+
+// Static data
+
+// A block is written once it holds this many records, or this many bytes.
+static const quint32 blockRecordLimit = 4096;
+static const int blockSizeLimit = 1048576;
+
+// Static functions
+
+template<typename T>
+static void
+appendInteger(QByteArray &buffer, T value)
+{
+    uchar bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    buffer.append(reinterpret_cast<const char *>(bytes), sizeof(T));
+}
+
+static void
+writeBuffer(QFile &file, const QByteArray &buffer)
+{
+    if (file.write(buffer) != buffer.size()) {
+        throw Error(qApp->translate("CaptureFile",
+                                    "failed to write '%1': %2").
+                    arg(file.fileName(), file.errorString()));
+    }
+}
+
+static void
+writeBlock(QFile &file, QByteArray &block, quint32 recordCount)
+{
+    QByteArray header;
+    appendInteger<quint32>(header, CaptureFile::BLOCK_MAGIC);
+    appendInteger<quint32>(header, recordCount);
+    appendInteger<quint32>(header, static_cast<quint32>(block.size()));
+    writeBuffer(file, header);
+    writeBuffer(file, block);
+    block.resize(0);
+}
+
+// Class definition
+
+void
+CaptureFile::save(const QString &path, const MessageTableModel &model)
+{
+    QFile file(path);
+    if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        throw Error(tr("failed to open '%1': %2").
+                    arg(path, file.errorString()));
+    }
+
+    // Port names are written once, and records refer to them by index.  They
+    // are gathered without getting whole messages, which would read spilled
+    // messages back from disk.
+    int count = model.rowCount();
+    QHash<QString, quint16> portIndexes;
+    QStringList portNames;
+    for (int i = 0; i < count; i++) {
+        QString port =
+            model.data(model.index(i, MessageTableModel::COLUMN_PORT)).
+            toString();
+        if (! portIndexes.contains(port)) {
+            portIndexes.insert(port, static_cast<quint16>(portNames.count()));
+            portNames.append(port);
+        }
+    }
+    QByteArray header;
+    appendInteger<quint32>(header, FILE_MAGIC);
+    appendInteger<quint32>(header, VERSION);
+    appendInteger<quint32>(header, static_cast<quint32>(portNames.count()));
+    for (int i = 0; i < portNames.count(); i++) {
+        QByteArray name = portNames[i].toUtf8();
+        appendInteger<quint32>(header, static_cast<quint32>(name.size()));
+        header.append(name);
+    }
+    writeBuffer(file, header);
+
+    QByteArray block;
+    quint32 recordCount = 0;
+    for (int i = 0; i < count; i++) {
+        MessageTableModel::Message message = model.getMessage(i);
+        appendInteger<quint64>(block, message.timeStamp);
+        appendInteger<quint32>(block, message.length);
+        appendInteger<quint32>(block, message.totalDropped);
+        appendInteger<quint16>(block, portIndexes.value(message.port));
+        appendInteger<quint8>(block, static_cast<quint8>(message.type));
+        appendInteger<quint32>(block,
+                               static_cast<quint32>(message.data.size()));
+        block.append(message.data);
+        recordCount++;
+        if ((recordCount == blockRecordLimit) ||
+            (block.size() >= blockSizeLimit)) {
+            writeBlock(file, block, recordCount);
+            recordCount = 0;
+        }
+    }
+    if (recordCount) {
+        writeBlock(file, block, recordCount);
+    }
+    file.close();
+    if (file.error() != QFile::NoError) {
+        throw Error(tr("failed to write '%1': %2").
+                    arg(path, file.errorString()));
+    }
+}
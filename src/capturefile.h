@@ -0,0 +1,65 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __CAPTUREFILE_H__
+#define __CAPTUREFILE_H__
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QString>
+
+#include "messagetablemodel.h"
+
+// The layout of a midisnoop capture file.  All integers are little-endian.
+//
+// The file starts with `FILE_MAGIC`, `VERSION` and the number of port names
+// (32 bits each), followed by each port name as a 32-bit byte count and the
+// name's UTF-8 bytes.  The rest of the file is a sequence of blocks.  Each
+// block starts with `BLOCK_MAGIC`, the number of records in the block and the
+// number of bytes of records that follow (32 bits each).  A record is a
+// timestamp (64 bits), the message length and total dropped count (32 bits
+// each, see `MessageTableModel::Message`), the index of the port name (16
+// bits), the message type (8 bits), and the number of data bytes (32 bits)
+// followed by the data itself.
+//
+// Blocks hold whole records, so they can be read independently of each
+// other.
+
+class CaptureFile {
+
+    Q_DECLARE_TR_FUNCTIONS(CaptureFile)
+
+public:
+
+    static const quint32 BLOCK_HEADER_SIZE = 12;
+    static const quint32 BLOCK_MAGIC = 0x4b4c4253;
+    static const quint32 FILE_MAGIC = 0x50414e53;
+    static const quint32 RECORD_HEADER_SIZE = 23;
+    static const quint32 VERSION = 1;
+
+    // Writes every message in `model` to a new capture file at `path`.
+    static void
+    save(const QString &path, const MessageTableModel &model);
+
+private:
+
+    CaptureFile();
+
+};
+
+#endif
@@ -0,0 +1,389 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+
+#include <QtCore/QMutexLocker>
+#include <QtCore/QRunnable>
+#include <QtCore/QtEndian>
+
+#include "capturefile.h"
+#include "captureloader.h"
+#include "error.h"
+
+// Static data
+
+// The number of chunks, per pool thread, that can be decoded or waiting to
+// be built at once.
+static const int chunksInFlightPerThread = 2;
+
+// How often built pages are handed over, in milliseconds.
+static const int handOverInterval = 16;
+
+// Pages stop being built once this many rows are waiting to be handed over,
+// so that the GUI thread isn't kept busy inserting rows for too long, and
+// pages don't pile up when it's busy.
+static const int handOverRowLimit = 65536;
+
+// Static functions
+
+template<typename T>
+static T
+readInteger(const uchar *&data)
+{
+    T value = qFromLittleEndian<T>(data);
+    data += sizeof(T);
+    return value;
+}
+
+// Job class
+
+// Decodes a chunk, if it's given one, and then builds the pages that can be
+// built.
+
+class CaptureLoader::Job: public QRunnable {
+
+public:
+
+    Job(CaptureLoader &loader, Chunk *chunk):
+        chunk(chunk),
+        loader(loader)
+    {
+        // Empty
+    }
+
+    void
+    run()
+    {
+        if (chunk) {
+            decodeChunk(*chunk, loader.portNames.count(), loader.cancelled);
+            chunk->done.storeRelease(1);
+        }
+        loader.buildPages();
+    }
+
+private:
+
+    Chunk *chunk;
+    CaptureLoader &loader;
+
+};
+
+// Static functions
+
+void
+CaptureLoader::decodeChunk(Chunk &chunk, int portCount,
+                           const QAtomicInt &cancelled)
+{
+    const uchar *data = chunk.data;
+    const uchar *end = data + chunk.size;
+    int count = static_cast<int>(chunk.recordCount);
+    chunk.decodedMessages.resize(count);
+    chunk.messages.resize(count);
+    for (int i = 0; i < count; i++) {
+
+        // A cancelled chunk is marked as failed, so that its messages are
+        // never built.
+        if ((! (i & 0xff)) && cancelled.loadAcquire()) {
+            chunk.failed = true;
+            return;
+        }
+        if (static_cast<quint32>(end - data) <
+            CaptureFile::RECORD_HEADER_SIZE) {
+            chunk.failed = true;
+            return;
+        }
+        MessageTableModel::MessageRef &message = chunk.messages[i];
+        message.annotation.kind = Annotation::KIND_NONE;
+        message.timeStamp = readInteger<quint64>(data);
+        message.length = readInteger<quint32>(data);
+        message.totalDropped = readInteger<quint32>(data);
+        quint16 port = readInteger<quint16>(data);
+        quint8 type = readInteger<quint8>(data);
+        quint32 size = readInteger<quint32>(data);
+        if ((port >= portCount) ||
+            (type > MessageTableModel::MESSAGETYPE_DROPPED) ||
+            (static_cast<quint32>(end - data) < size)) {
+            chunk.failed = true;
+            return;
+        }
+        message.data = data;
+        message.dataSize = size;
+        message.port = port;
+        message.spillOffset = 0;
+        message.type = static_cast<MessageTableModel::MessageType>(type);
+        data += size;
+
+        // Only received messages are annotated, so the others are left
+        // undecoded.
+        DecodedMessage &decoded = chunk.decodedMessages[i];
+        if (message.type == MessageTableModel::MESSAGETYPE_RECEIVED) {
+            decoded = decodeMessage(message.data, size);
+        } else {
+            decoded.kind = DecodedMessage::KIND_EMPTY;
+        }
+    }
+    if (data != end) {
+        chunk.failed = true;
+    }
+}
+
+// Class definition
+
+CaptureLoader::CaptureLoader(QObject *parent):
+    QObject(parent)
+{
+    building = false;
+    cancelled.store(0);
+    failedChunk = -1;
+    map = 0;
+    nextChunk = 0;
+    startedChunks = 0;
+    connect(&handOverTimer, SIGNAL(timeout()), SLOT(handOverPages()));
+    handOverTimer.setInterval(handOverInterval);
+}
+
+CaptureLoader::~CaptureLoader()
+{
+    cancel();
+}
+
+void
+CaptureLoader::buildPages()
+{
+    QMutexLocker locker(&mutex);
+    if (building) {
+        return;
+    }
+    building = true;
+    int chunkCount = chunks.count();
+    while ((failedChunk == -1) && (nextChunk < chunkCount) &&
+           (pages.getRowCount() < handOverRowLimit) &&
+           (! cancelled.loadAcquire())) {
+        Chunk *chunk = chunks[nextChunk];
+        if (! chunk->done.loadAcquire()) {
+            break;
+        }
+        if (chunk->failed) {
+
+            // The messages before the damaged block are still handed over.
+            pageBuilder.finish();
+            pages.takePages(pageBuilder);
+            failedChunk = nextChunk;
+            break;
+        }
+        bool last = nextChunk == (chunkCount - 1);
+        locker.unlock();
+
+        // Annotations depend on the messages before them, which is why
+        // chunks are built in file order.
+        int count = chunk->messages.count();
+        for (int i = 0; i < count; i++) {
+            MessageTableModel::MessageRef &message = chunk->messages[i];
+            if (message.type == MessageTableModel::MESSAGETYPE_RECEIVED) {
+                message.annotation =
+                    annotator.annotate(message.port,
+                                       chunk->decodedMessages[i]);
+            }
+            pageBuilder.addMessage(message);
+        }
+        if (last) {
+            pageBuilder.finish();
+        }
+        chunk->decodedMessages = QVector<DecodedMessage>();
+        chunk->messages = QVector<MessageTableModel::MessageRef>();
+
+        locker.relock();
+        pages.takePages(pageBuilder);
+        nextChunk++;
+        startJobs();
+    }
+    building = false;
+}
+
+void
+CaptureLoader::cancel()
+{
+    cancelled.storeRelease(1);
+    threadPool.waitForDone();
+    handOverTimer.stop();
+    qDeleteAll(chunks);
+    chunks.clear();
+    building = false;
+    failedChunk = -1;
+    nextChunk = 0;
+    pageBuilder.clear();
+    pages.clear();
+    portNames.clear();
+    startedChunks = 0;
+    if (map) {
+        file.unmap(map);
+        map = 0;
+    }
+    file.close();
+}
+
+void
+CaptureLoader::fail(const QString &message)
+{
+    QString path = file.fileName();
+    cancel();
+    emit loadFailed(tr("'%1' is damaged: %2").arg(path, message));
+}
+
+void
+CaptureLoader::handOverPages()
+{
+    MessageTableModel::PageBuilder builtPages;
+    bool finished;
+    int failed;
+    bool stopped;
+    {
+        QMutexLocker locker(&mutex);
+        builtPages.takePages(pages);
+        failed = failedChunk;
+        finished = nextChunk == chunks.count();
+
+        // Building stops while a batch of pages is waiting, and has to be
+        // started again once the batch is taken.
+        stopped = (! building) && (! finished) && (failed == -1) &&
+            chunks[nextChunk]->done.loadAcquire();
+    }
+    if (stopped) {
+        threadPool.start(new Job(*this, 0));
+    }
+    if (builtPages.getRowCount()) {
+        emit pagesLoaded(builtPages);
+    }
+    if (failed != -1) {
+        fail(tr("block %1 is invalid").arg(failed + 1));
+    } else if (finished) {
+        cancel();
+        emit loadFinished();
+    }
+}
+
+bool
+CaptureLoader::isLoading() const
+{
+    return handOverTimer.isActive();
+}
+
+void
+CaptureLoader::load(const QString &path)
+{
+    cancel();
+    file.setFileName(path);
+    if (! file.open(QIODevice::ReadOnly)) {
+        throw Error(tr("failed to open '%1': %2").
+                    arg(path, file.errorString()));
+    }
+    try {
+        quint64 size = static_cast<quint64>(file.size());
+        if (size < 12) {
+            throw Error(tr("'%1' is not a midisnoop capture file").arg(path));
+        }
+        map = file.map(0, static_cast<qint64>(size));
+        if (! map) {
+            throw Error(tr("failed to map '%1': %2").
+                        arg(path, file.errorString()));
+        }
+        const uchar *data = map;
+        const uchar *end = map + size;
+        if (readInteger<quint32>(data) != CaptureFile::FILE_MAGIC) {
+            throw Error(tr("'%1' is not a midisnoop capture file").arg(path));
+        }
+        if (readInteger<quint32>(data) != CaptureFile::VERSION) {
+            throw Error(tr("'%1' was saved by an unsupported version of "
+                           "midisnoop").arg(path));
+        }
+        QString damaged = tr("'%1' is damaged").arg(path);
+        quint32 portCount = readInteger<quint32>(data);
+        if (portCount > 0x10000) {
+            throw Error(damaged);
+        }
+        for (quint32 i = 0; i < portCount; i++) {
+            if ((end - data) < 4) {
+                throw Error(damaged);
+            }
+            quint32 length = readInteger<quint32>(data);
+            if (static_cast<quint32>(end - data) < length) {
+                throw Error(damaged);
+            }
+            portNames.append(QString::fromUtf8
+                             (reinterpret_cast<const char *>(data),
+                              static_cast<int>(length)));
+            data += length;
+        }
+
+        // Only the block headers are read here.  Each block becomes a chunk
+        // that's decoded on the thread pool.
+        while (data != end) {
+            if (static_cast<quint32>(end - data) <
+                CaptureFile::BLOCK_HEADER_SIZE) {
+                throw Error(damaged);
+            }
+            if (readInteger<quint32>(data) != CaptureFile::BLOCK_MAGIC) {
+                throw Error(damaged);
+            }
+            quint32 recordCount = readInteger<quint32>(data);
+            quint32 blockSize = readInteger<quint32>(data);
+            if ((static_cast<quint32>(end - data) < blockSize) ||
+                ((recordCount * static_cast<quint64>
+                  (CaptureFile::RECORD_HEADER_SIZE)) > blockSize)) {
+                throw Error(damaged);
+            }
+            Chunk *chunk = new Chunk();
+            chunk->data = data;
+            chunk->done.store(0);
+            chunk->failed = false;
+            chunk->recordCount = recordCount;
+            chunk->size = blockSize;
+            chunks.append(chunk);
+            data += blockSize;
+        }
+    } catch (...) {
+        cancel();
+        throw;
+    }
+
+    // Chunks are queued in file order, so the first ones are decoded first.
+    annotator.reset();
+    pageBuilder.setPortNames(portNames);
+    cancelled.store(0);
+    {
+        QMutexLocker locker(&mutex);
+        startJobs();
+    }
+    handOverTimer.start();
+}
+
+void
+CaptureLoader::startJobs()
+{
+    int limit = qMax(threadPool.maxThreadCount(), 1) *
+        chunksInFlightPerThread;
+    int chunkCount = chunks.count();
+    while ((startedChunks < chunkCount) &&
+           ((startedChunks - nextChunk) < limit) &&
+           (! cancelled.loadAcquire())) {
+        threadPool.start(new Job(*this, chunks[startedChunks]));
+        startedChunks++;
+    }
+}
@@ -0,0 +1,147 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __CAPTURELOADER_H__
+#define __CAPTURELOADER_H__
+
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QStringList>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+
+#include "messageannotator.h"
+#include "messagetablemodel.h"
+
+// Loads capture files (see `CaptureFile`).  The file is mapped into memory,
+// and each of its blocks is decoded on a thread pool as a chunk of its own.
+// Decoded chunks are then annotated and built into pages in file order, by
+// one pool thread at a time, and the pages are handed over to the GUI thread
+// in batches, so the first messages can be shown while the rest of the file
+// is still being decoded.
+//
+// Only a few chunks are decoded ahead of the pages that are being built, and
+// building stops while the GUI thread has a batch of pages waiting, so the
+// memory used by a load doesn't grow with the size of the file.
+
+class CaptureLoader: public QObject {
+
+    Q_OBJECT
+
+public:
+
+    explicit
+    CaptureLoader(QObject *parent=0);
+
+    ~CaptureLoader();
+
+    bool
+    isLoading() const;
+
+public slots:
+
+    // Stops the current load, if any.  Messages that haven't been handed
+    // over yet are discarded.
+    void
+    cancel();
+
+    // Starts loading the capture file at `path`, replacing the current load.
+    // Throws an `Error` if the file can't be opened, or if its headers are
+    // damaged.
+    void
+    load(const QString &path);
+
+signals:
+
+    void
+    loadFailed(const QString &message);
+
+    void
+    loadFinished();
+
+    // Connections must be direct.  The receiver takes the pages from
+    // `pages`.
+    void
+    pagesLoaded(MessageTableModel::PageBuilder &pages);
+
+private slots:
+
+    void
+    handOverPages();
+
+private:
+
+    // A block of the file, and the messages decoded from it.  The messages'
+    // data points into the mapped file, and their ports are indexes into the
+    // file's port names.  The decoded messages are only needed to annotate
+    // received messages.
+    struct Chunk {
+        const uchar *data;
+        QVector<DecodedMessage> decodedMessages;
+        QAtomicInt done;
+        bool failed;
+        QVector<MessageTableModel::MessageRef> messages;
+        quint32 recordCount;
+        quint32 size;
+    };
+
+    class Job;
+
+    static void
+    decodeChunk(Chunk &chunk, int portCount, const QAtomicInt &cancelled);
+
+    // Annotates decoded chunks and builds their pages, in file order, until
+    // the next chunk isn't decoded yet, or a batch of pages is waiting to be
+    // handed over.  Called by pool threads.
+    void
+    buildPages();
+
+    void
+    fail(const QString &message);
+
+    // Starts decoding chunks, until there are as many chunks in flight as
+    // are allowed.  `mutex` must be locked.
+    void
+    startJobs();
+
+    // Used by the pool thread that's building pages.
+    MessageAnnotator annotator;
+    MessageTableModel::PageBuilder pageBuilder;
+
+    // Guarded by `mutex`.
+    bool building;
+    int failedChunk;
+    int nextChunk;
+    MessageTableModel::PageBuilder pages;
+    int startedChunks;
+
+    QAtomicInt cancelled;
+    QList<Chunk *> chunks;
+    QFile file;
+    QTimer handOverTimer;
+    uchar *map;
+    QMutex mutex;
+    QStringList portNames;
+    QThreadPool threadPool;
+
+};
+
+#endif
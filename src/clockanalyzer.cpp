@@ -0,0 +1,203 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cmath>
+
+#include <QtCore/QThread>
+
+#include "clockanalyzer.h"
+
+// Static data
+
+// A gap between ticks longer than this, in microseconds, means that the
+// clock stopped.
+static const quint64 maximumTickInterval = 1000000;
+
+// Class definition
+
+ClockAnalyzer::ClockAnalyzer():
+    resetGeneration(0),
+    resetRequests(0),
+    sequence(0)
+{
+    clear();
+}
+
+ClockAnalyzer::~ClockAnalyzer()
+{
+    // Empty
+}
+
+void
+ClockAnalyzer::addTick(quint64 time)
+{
+    beginUpdate();
+    int requests = resetRequests.loadAcquire();
+    if (requests != resetGeneration) {
+        resetGeneration = requests;
+        clear();
+    }
+    quint64 previousTick = lastTick.load();
+    if ((! previousTick) || (time < previousTick) ||
+        ((time - previousTick) > maximumTickInterval)) {
+        clear();
+        firstTick.storeRelease(time);
+        lastTick.storeRelease(time);
+        endUpdate();
+        return;
+    }
+    quint64 interval = time - previousTick;
+
+    // The first interval of a run seeds the smoothed interval.  After that,
+    // each interval is compared to the smoothed interval before it, and then
+    // moves it 1/16 of the way towards itself.
+    quint64 smoothed = smoothedInterval.load();
+    if (! smoothed) {
+        smoothed = interval << 8;
+    }
+    qint64 deviation = static_cast<qint64>(interval) -
+        static_cast<qint64>(smoothed >> 8);
+    int half = ClockStatistics::HISTOGRAM_SIZE / 2;
+    qint64 bucket = half + ((deviation >= 0 ?
+                             deviation + (ClockStatistics::
+                                          HISTOGRAM_BUCKET_WIDTH / 2) :
+                             deviation - (ClockStatistics::
+                                          HISTOGRAM_BUCKET_WIDTH / 2)) /
+                            ClockStatistics::HISTOGRAM_BUCKET_WIDTH);
+    if (bucket < 0) {
+        bucket = 0;
+    } else if (bucket >= ClockStatistics::HISTOGRAM_SIZE) {
+        bucket = ClockStatistics::HISTOGRAM_SIZE - 1;
+    }
+    histogram[bucket].storeRelease(histogram[bucket].load() + 1);
+    smoothed = static_cast<quint64>(static_cast<qint64>(smoothed) +
+                                    (((static_cast<qint64>(interval) << 8) -
+                                      static_cast<qint64>(smoothed)) / 16));
+    smoothedInterval.storeRelease(smoothed);
+
+    quint32 count = intervalCount.load();
+    if ((! count) || (interval < minimumInterval.load())) {
+        minimumInterval.storeRelease(interval);
+    }
+    if (interval > maximumInterval.load()) {
+        maximumInterval.storeRelease(interval);
+    }
+    totalInterval.storeRelease(totalInterval.load() + interval);
+    totalSquaredInterval.storeRelease(totalSquaredInterval.load() +
+                                      (interval * interval));
+    lastInterval.storeRelease(interval);
+    lastTick.storeRelease(time);
+    intervalCount.storeRelease(count + 1);
+    endUpdate();
+}
+
+void
+ClockAnalyzer::beginUpdate()
+{
+    // A read-modify-write, so that none of the writes in the update can be
+    // seen before the sequence number is odd.
+    sequence.fetchAndAddOrdered(1);
+}
+
+void
+ClockAnalyzer::clear()
+{
+    intervalCount.storeRelease(0);
+    firstTick.storeRelease(0);
+    for (int i = 0; i < ClockStatistics::HISTOGRAM_SIZE; i++) {
+        histogram[i].storeRelease(0);
+    }
+    lastInterval.storeRelease(0);
+    lastTick.storeRelease(0);
+    maximumInterval.storeRelease(0);
+    minimumInterval.storeRelease(0);
+    smoothedInterval.storeRelease(0);
+    totalInterval.storeRelease(0);
+    totalSquaredInterval.storeRelease(0);
+}
+
+void
+ClockAnalyzer::endUpdate()
+{
+    sequence.storeRelease(sequence.load() + 1);
+}
+
+ClockStatistics
+ClockAnalyzer::getStatistics() const
+{
+    ClockStatistics statistics;
+    quint32 count;
+    quint64 total;
+    quint64 totalSquared;
+    for (;;) {
+        quint32 start = sequence.loadAcquire();
+        if (! (start & 1)) {
+
+            // Every field is read with acquire semantics, so if any of them
+            // was written by a later update, then the second read of the
+            // sequence number sees that update's odd number, at least.
+            count = intervalCount.loadAcquire();
+            statistics.firstTick = firstTick.loadAcquire();
+            for (int i = 0; i < ClockStatistics::HISTOGRAM_SIZE; i++) {
+                statistics.histogram[i] = histogram[i].loadAcquire();
+            }
+            statistics.lastInterval = lastInterval.loadAcquire();
+            statistics.lastTick = lastTick.loadAcquire();
+            statistics.maximumInterval = maximumInterval.loadAcquire();
+            statistics.minimumInterval = minimumInterval.loadAcquire();
+            statistics.smoothedInterval =
+                smoothedInterval.loadAcquire() / 256.0;
+            total = totalInterval.loadAcquire();
+            totalSquared = totalSquaredInterval.loadAcquire();
+            if (sequence.load() == start) {
+                break;
+            }
+        } else {
+
+            // Updates are short, unless the writer was preempted.
+            QThread::yieldCurrentThread();
+        }
+    }
+    statistics.intervalCount = count;
+    if (count) {
+        double mean = static_cast<double>(total) / count;
+        double meanSquare = static_cast<double>(totalSquared) / count;
+        statistics.meanInterval = mean;
+        statistics.standardDeviation =
+            std::sqrt(qMax(meanSquare - (mean * mean), 0.0));
+    } else {
+        statistics.meanInterval = 0.0;
+        statistics.standardDeviation = 0.0;
+    }
+    return statistics;
+}
+
+void
+ClockAnalyzer::requestReset()
+{
+    resetRequests.ref();
+}
+
+void
+ClockAnalyzer::restart()
+{
+    beginUpdate();
+    clear();
+    endUpdate();
+}
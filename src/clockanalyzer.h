@@ -0,0 +1,128 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __CLOCKANALYZER_H__
+#define __CLOCKANALYZER_H__
+
+#include <QtCore/QAtomicInteger>
+
+// A snapshot of a `ClockAnalyzer`'s statistics.  Times and intervals are in
+// microseconds.  `histogram` counts the deviation of each interval between
+// ticks from the smoothed interval before it, in buckets of
+// `HISTOGRAM_BUCKET_WIDTH` microseconds centred on zero.  The first and last
+// buckets also count every deviation beyond them.
+
+struct ClockStatistics {
+
+    static const int HISTOGRAM_BUCKET_WIDTH = 125;
+    static const int HISTOGRAM_SIZE = 33;
+
+    // Returns the tempo, in beats per minute, of clock ticks `interval`
+    // microseconds apart.
+    static double
+    getTempo(double interval)
+    {
+        return interval > 0.0 ? 2500000.0 / interval : 0.0;
+    }
+
+    quint64 firstTick;
+    quint32 histogram[HISTOGRAM_SIZE];
+    quint32 intervalCount;
+    quint64 lastInterval;
+    quint64 lastTick;
+    quint64 maximumInterval;
+    double meanInterval;
+    quint64 minimumInterval;
+    double smoothedInterval;
+    double standardDeviation;
+
+};
+
+// Analyzes the MIDI clock ticks received on a port.  Ticks are added by the
+// port's callback thread, and statistics are read by the GUI thread.  As with
+// `LatencyStatistics`, there's only ever one writer.  The analyzer's state is
+// a fixed size, no matter how many ticks it sees.
+//
+// The writer makes the sequence number odd while it updates the state, and
+// even again when it's done, so that a reader can tell when the snapshot it
+// took was torn by an update, and take it again.
+//
+// A run of ticks restarts after a start message, after a gap of more than a
+// second between ticks, and after a reset is requested.
+
+class ClockAnalyzer {
+
+public:
+
+    ClockAnalyzer();
+
+    ~ClockAnalyzer();
+
+    // Called by the writer.
+    void
+    addTick(quint64 time);
+
+    ClockStatistics
+    getStatistics() const;
+
+    // Can be called from any thread.  The writer restarts the run when it
+    // adds the next tick.
+    void
+    requestReset();
+
+    // Called by the writer.
+    void
+    restart();
+
+private:
+
+    ClockAnalyzer(const ClockAnalyzer &);
+
+    ClockAnalyzer &
+    operator=(const ClockAnalyzer &);
+
+    void
+    beginUpdate();
+
+    void
+    clear();
+
+    void
+    endUpdate();
+
+    QAtomicInteger<quint64> firstTick;
+    QAtomicInteger<quint32> histogram[ClockStatistics::HISTOGRAM_SIZE];
+    QAtomicInteger<quint32> intervalCount;
+    QAtomicInteger<quint64> lastInterval;
+    QAtomicInteger<quint64> lastTick;
+    QAtomicInteger<quint64> maximumInterval;
+    QAtomicInteger<quint64> minimumInterval;
+    int resetGeneration;
+    QAtomicInt resetRequests;
+    QAtomicInteger<quint32> sequence;
+
+    // The smoothed interval has 8 fractional bits.
+    QAtomicInteger<quint64> smoothedInterval;
+
+    QAtomicInteger<quint64> totalInterval;
+    QAtomicInteger<quint64> totalSquaredInterval;
+
+};
+
+#endif
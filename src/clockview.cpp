@@ -0,0 +1,173 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+
+#include "clockview.h"
+#include "util.h"
+
+ClockView::ClockView(QObject *parent):
+    DesignerView(":/midisnoop/clockview.ui", parent)
+{
+    QWidget *rootWidget = getRootWidget();
+
+    clockAnalysisEnabled =
+        getChild<QCheckBox>(rootWidget, "clockAnalysisEnabled");
+    connect(clockAnalysisEnabled, SIGNAL(clicked(bool)),
+            SIGNAL(clockAnalysisEnabledChangeRequest(bool)));
+
+    closeButton = getChild<QPushButton>(rootWidget, "closeButton");
+    connect(closeButton, SIGNAL(clicked()), SIGNAL(closeRequest()));
+
+    // Each bucket is labelled with the deviation at its centre.  The outer
+    // buckets also hold every larger deviation.
+    histogram = getChild<QTableWidget>(rootWidget, "histogram");
+    int half = ClockStatistics::HISTOGRAM_SIZE / 2;
+    histogram->setRowCount(ClockStatistics::HISTOGRAM_SIZE);
+    for (int i = 0; i < ClockStatistics::HISTOGRAM_SIZE; i++) {
+        double deviation = ((i - half) *
+                            ClockStatistics::HISTOGRAM_BUCKET_WIDTH) / 1000.0;
+        QString text = tr("%1 ms").arg(deviation, 0, 'f', 3);
+        if (! i) {
+            text = tr("<= %1").arg(text);
+        } else if (i == (ClockStatistics::HISTOGRAM_SIZE - 1)) {
+            text = tr(">= %1").arg(text);
+        }
+        setItemText(histogram, i, 0, text);
+    }
+
+    portTable = getChild<QTableWidget>(rootWidget, "ports");
+    connect(portTable, SIGNAL(itemSelectionChanged()),
+            SLOT(updateHistogram()));
+
+    referenceTempo = getChild<QDoubleSpinBox>(rootWidget, "referenceTempo");
+    connect(referenceTempo, SIGNAL(valueChanged(double)),
+            SLOT(updatePorts()));
+
+    resetButton = getChild<QPushButton>(rootWidget, "resetButton");
+    connect(resetButton, SIGNAL(clicked()), SIGNAL(resetRequest()));
+}
+
+ClockView::~ClockView()
+{
+    // Empty
+}
+
+void
+ClockView::setClockAnalysisEnabled(bool enabled)
+{
+    clockAnalysisEnabled->setChecked(enabled);
+}
+
+void
+ClockView::setItemText(QTableWidget *table, int row, int column,
+                       const QString &text)
+{
+    QTableWidgetItem *item = table->item(row, column);
+    if (! item) {
+        item = new QTableWidgetItem();
+        item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+        table->setItem(row, column, item);
+    }
+    item->setText(text);
+}
+
+void
+ClockView::setStatistics(const QStringList &ports,
+                         const QVector<ClockStatistics> &statistics)
+{
+    assert(ports.count() == statistics.count());
+    this->ports = ports;
+    this->statistics = statistics;
+    updatePorts();
+    updateHistogram();
+}
+
+void
+ClockView::updateHistogram()
+{
+    int row = portTable->currentRow();
+    const ClockStatistics *portStatistics = 0;
+    if ((row >= 0) && (row < statistics.count()) &&
+        statistics[row].intervalCount) {
+        portStatistics = &(statistics[row]);
+    }
+    for (int i = 0; i < ClockStatistics::HISTOGRAM_SIZE; i++) {
+        if (! portStatistics) {
+            setItemText(histogram, i, 1, QString());
+            setItemText(histogram, i, 2, QString());
+            continue;
+        }
+        quint32 count = portStatistics->histogram[i];
+        setItemText(histogram, i, 1, QString::number(count));
+        setItemText(histogram, i, 2,
+                    tr("%1%").arg((100.0 * count) /
+                                  portStatistics->intervalCount, 0, 'f', 1));
+    }
+}
+
+void
+ClockView::updatePorts()
+{
+    // Drift is the difference between the time the ticks actually took and
+    // the time they'd take at the reference tempo.
+    double referenceInterval = 2500000.0 / referenceTempo->value();
+    int count = statistics.count();
+    portTable->setRowCount(count);
+    for (int i = 0; i < count; i++) {
+        const ClockStatistics &portStatistics = statistics[i];
+        setItemText(portTable, i, PORTCOLUMN_PORT, ports[i]);
+        setItemText(portTable, i, PORTCOLUMN_TICKS,
+                    QString::number(portStatistics.intervalCount));
+        if (! portStatistics.intervalCount) {
+            for (int j = PORTCOLUMN_TEMPO; j < PORTCOLUMN_TOTAL; j++) {
+                setItemText(portTable, i, j, tr("-"));
+            }
+            continue;
+        }
+        double mean = portStatistics.meanInterval;
+        setItemText(portTable, i, PORTCOLUMN_TEMPO,
+                    tr("%1 BPM").
+                    arg(ClockStatistics::getTempo(portStatistics.lastInterval),
+                        0, 'f', 2));
+        setItemText(portTable, i, PORTCOLUMN_SMOOTHED_TEMPO,
+                    tr("%1 BPM").
+                    arg(ClockStatistics::
+                        getTempo(portStatistics.smoothedInterval),
+                        0, 'f', 2));
+        setItemText(portTable, i, PORTCOLUMN_MINIMUM_JITTER,
+                    tr("%1 ms").
+                    arg((portStatistics.minimumInterval - mean) / 1000.0, 0,
+                        'f', 3));
+        setItemText(portTable, i, PORTCOLUMN_MAXIMUM_JITTER,
+                    tr("%1 ms").
+                    arg((portStatistics.maximumInterval - mean) / 1000.0, 0,
+                        'f', 3));
+        setItemText(portTable, i, PORTCOLUMN_STANDARD_DEVIATION,
+                    tr("%1 ms").
+                    arg(portStatistics.standardDeviation / 1000.0, 0, 'f',
+                        3));
+        double expected = portStatistics.intervalCount * referenceInterval;
+        double drift =
+            (portStatistics.lastTick - portStatistics.firstTick) - expected;
+        setItemText(portTable, i, PORTCOLUMN_DRIFT,
+                    tr("%1 ms (%2 ppm)").arg(drift / 1000.0, 0, 'f', 3).
+                    arg((drift * 1000000.0) / expected, 0, 'f', 0));
+    }
+}
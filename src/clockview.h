@@ -0,0 +1,100 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __CLOCKVIEW_H__
+#define __CLOCKVIEW_H__
+
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+#include <QtWidgets/QCheckBox>
+#include <QtWidgets/QDoubleSpinBox>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QTableWidget>
+
+#include "clockanalyzer.h"
+#include "designerview.h"
+
+class ClockView: public DesignerView {
+
+    Q_OBJECT
+
+public:
+
+    explicit
+    ClockView(QObject *parent=0);
+
+    ~ClockView();
+
+public slots:
+
+    void
+    setClockAnalysisEnabled(bool enabled);
+
+    // Shows the clock statistics of each port in `ports`.
+    void
+    setStatistics(const QStringList &ports,
+                  const QVector<ClockStatistics> &statistics);
+
+signals:
+
+    void
+    clockAnalysisEnabledChangeRequest(bool enabled);
+
+    void
+    resetRequest();
+
+private slots:
+
+    void
+    updateHistogram();
+
+    void
+    updatePorts();
+
+private:
+
+    enum PortColumn {
+        PORTCOLUMN_PORT = 0,
+        PORTCOLUMN_TICKS = 1,
+        PORTCOLUMN_TEMPO = 2,
+        PORTCOLUMN_SMOOTHED_TEMPO = 3,
+        PORTCOLUMN_MINIMUM_JITTER = 4,
+        PORTCOLUMN_MAXIMUM_JITTER = 5,
+        PORTCOLUMN_STANDARD_DEVIATION = 6,
+        PORTCOLUMN_DRIFT = 7,
+
+        PORTCOLUMN_TOTAL = 8
+    };
+
+    void
+    setItemText(QTableWidget *table, int row, int column,
+                const QString &text);
+
+    QCheckBox *clockAnalysisEnabled;
+    QPushButton *closeButton;
+    QTableWidget *histogram;
+    QStringList ports;
+    QTableWidget *portTable;
+    QDoubleSpinBox *referenceTempo;
+    QPushButton *resetButton;
+    QVector<ClockStatistics> statistics;
+
+};
+
+#endif
@@ -20,11 +20,27 @@
 #include "configureview.h"
 #include "util.h"
 
+// Class definition
+
 ConfigureView::ConfigureView(QObject *parent):
     DesignerView(":/midisnoop/configureview.ui", parent)
 {
     QWidget *rootWidget = getRootWidget();
 
+    captureByteLimit = getChild<QSpinBox>(rootWidget, "captureByteLimit");
+    connect(captureByteLimit, SIGNAL(valueChanged(int)),
+            SLOT(handleCaptureByteLimitChange(int)));
+
+    captureEventLimit = getChild<QSpinBox>(rootWidget, "captureEventLimit");
+    connect(captureEventLimit, SIGNAL(valueChanged(int)),
+            SIGNAL(captureEventLimitChangeRequest(int)));
+
+    captureStatus = getChild<QLabel>(rootWidget, "captureStatus");
+
+    deliveryRate = getChild<QSpinBox>(rootWidget, "deliveryRate");
+    connect(deliveryRate, SIGNAL(valueChanged(int)),
+            SIGNAL(deliveryRateChangeRequest(int)));
+
     driver = getChild<QComboBox>(rootWidget, "driver");
     connect(driver, SIGNAL(activated(int)),
             SLOT(handleDriverActivation(int)));
@@ -43,14 +59,48 @@ ConfigureView::ConfigureView(QObject *parent):
     connect(ignoreTimeEvents, SIGNAL(clicked(bool)),
             SIGNAL(ignoreTimeEventsChangeRequest(bool)));
 
-    inputPort = getChild<QComboBox>(rootWidget, "inputPort");
-    connect(inputPort, SIGNAL(activated(int)),
-            SLOT(handleInputPortActivation(int)));
+    inputPorts = getChild<QListWidget>(rootWidget, "inputPorts");
+    connect(inputPorts, SIGNAL(itemChanged(QListWidgetItem *)),
+            SLOT(handleInputPortChange(QListWidgetItem *)));
 
     outputPort = getChild<QComboBox>(rootWidget, "outputPort");
     connect(outputPort, SIGNAL(activated(int)),
             SLOT(handleOutputPortActivation(int)));
 
+    overflowPolicy = getChild<QComboBox>(rootWidget, "overflowPolicy");
+    connect(overflowPolicy, SIGNAL(activated(int)),
+            SIGNAL(overflowPolicyChangeRequest(int)));
+
+    realTimeCpu = getChild<QSpinBox>(rootWidget, "realTimeCpu");
+    connect(realTimeCpu, SIGNAL(valueChanged(int)),
+            SIGNAL(realTimeCpuChangeRequest(int)));
+
+    realTimeEnabled = getChild<QCheckBox>(rootWidget, "realTimeEnabled");
+    connect(realTimeEnabled, SIGNAL(clicked(bool)),
+            SIGNAL(realTimeEnabledChangeRequest(bool)));
+
+    realTimePolicy = getChild<QComboBox>(rootWidget, "realTimePolicy");
+    connect(realTimePolicy, SIGNAL(activated(int)),
+            SIGNAL(realTimePolicyChangeRequest(int)));
+
+    realTimePriority = getChild<QSpinBox>(rootWidget, "realTimePriority");
+    connect(realTimePriority, SIGNAL(valueChanged(int)),
+            SIGNAL(realTimePriorityChangeRequest(int)));
+
+    scrollbackByteLimit =
+        getChild<QSpinBox>(rootWidget, "scrollbackByteLimit");
+    connect(scrollbackByteLimit, SIGNAL(valueChanged(int)),
+            SLOT(handleScrollbackByteLimitChange(int)));
+
+    scrollbackRowLimit = getChild<QSpinBox>(rootWidget, "scrollbackRowLimit");
+    connect(scrollbackRowLimit, SIGNAL(valueChanged(int)),
+            SIGNAL(scrollbackRowLimitChangeRequest(int)));
+
+    messageFilterEditor = new MessageFilterEditor(rootWidget, this);
+    connect(messageFilterEditor,
+            SIGNAL(filterChangeRequest(const MessageFilter &)),
+            SIGNAL(messageFilterChangeRequest(const MessageFilter &)));
+
     closeButton = getChild<QPushButton>(rootWidget, "closeButton");
     connect(closeButton, SIGNAL(clicked()), SIGNAL(closeRequest()));
 }
@@ -69,7 +119,12 @@ ConfigureView::addDriver(int index, const QString &name)
 void
 ConfigureView::addInputPort(int index, const QString &name)
 {
-    inputPort->insertItem(index + 1, name);
+    QListWidgetItem *item = new QListWidgetItem(name);
+    item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable);
+    item->setCheckState(Qt::Unchecked);
+    inputPorts->blockSignals(true);
+    inputPorts->insertItem(index, item);
+    inputPorts->blockSignals(false);
 }
 
 void
@@ -78,6 +133,12 @@ ConfigureView::addOutputPort(int index, const QString &name)
     outputPort->insertItem(index + 1, name);
 }
 
+void
+ConfigureView::handleCaptureByteLimitChange(int kilobytes)
+{
+    emit captureByteLimitChangeRequest(kilobytes * 1024);
+}
+
 void
 ConfigureView::handleDriverActivation(int index)
 {
@@ -85,9 +146,15 @@ ConfigureView::handleDriverActivation(int index)
 }
 
 void
-ConfigureView::handleInputPortActivation(int index)
+ConfigureView::handleInputPortChange(QListWidgetItem *item)
 {
-    emit inputPortChangeRequest(index - 1);
+    // The check box is put back the way it was until the engine reports that
+    // the port was actually opened or closed.
+    bool open = item->checkState() == Qt::Checked;
+    inputPorts->blockSignals(true);
+    item->setCheckState(open ? Qt::Unchecked : Qt::Checked);
+    inputPorts->blockSignals(false);
+    emit inputPortOpenChangeRequest(inputPorts->row(item), open);
 }
 
 void
@@ -96,10 +163,17 @@ ConfigureView::handleOutputPortActivation(int index)
     emit outputPortChangeRequest(index - 1);
 }
 
+void
+ConfigureView::handleScrollbackByteLimitChange(int megabytes)
+{
+    emit scrollbackByteLimitChangeRequest(static_cast<qint64>(megabytes) *
+                                          1048576);
+}
+
 void
 ConfigureView::removeInputPort(int index)
 {
-    inputPort->removeItem(index + 1);
+    delete inputPorts->takeItem(index);
 }
 
 void
@@ -108,6 +182,30 @@ ConfigureView::removeOutputPort(int index)
     outputPort->removeItem(index + 1);
 }
 
+void
+ConfigureView::setCaptureByteLimit(int limit)
+{
+    captureByteLimit->setValue(limit / 1024);
+}
+
+void
+ConfigureView::setCaptureEventLimit(int limit)
+{
+    captureEventLimit->setValue(limit);
+}
+
+void
+ConfigureView::setCaptureStatus(const QString &status)
+{
+    captureStatus->setText(status);
+}
+
+void
+ConfigureView::setDeliveryRate(int rate)
+{
+    deliveryRate->setValue(rate);
+}
+
 void
 ConfigureView::setDriver(int index)
 {
@@ -133,9 +231,18 @@ ConfigureView::setIgnoreTimeEvents(bool ignore)
 }
 
 void
-ConfigureView::setInputPort(int index)
+ConfigureView::setInputPortOpen(int index, bool open)
 {
-    inputPort->setCurrentIndex(index + 1);
+    inputPorts->blockSignals(true);
+    inputPorts->item(index)->setCheckState(open ? Qt::Checked :
+                                           Qt::Unchecked);
+    inputPorts->blockSignals(false);
+}
+
+void
+ConfigureView::setMessageFilter(const MessageFilter &filter)
+{
+    messageFilterEditor->setFilter(filter);
 }
 
 void
@@ -143,3 +250,46 @@ ConfigureView::setOutputPort(int index)
 {
     outputPort->setCurrentIndex(index + 1);
 }
+
+void
+ConfigureView::setOverflowPolicy(int policy)
+{
+    overflowPolicy->setCurrentIndex(policy);
+}
+
+void
+ConfigureView::setRealTimeCpu(int cpu)
+{
+    realTimeCpu->setValue(cpu);
+}
+
+void
+ConfigureView::setRealTimeEnabled(bool enabled)
+{
+    realTimeEnabled->setChecked(enabled);
+}
+
+void
+ConfigureView::setRealTimePolicy(int policy)
+{
+    realTimePolicy->setCurrentIndex(policy);
+}
+
+void
+ConfigureView::setRealTimePriority(int priority)
+{
+    realTimePriority->setValue(priority);
+}
+
+void
+ConfigureView::setScrollbackByteLimit(qint64 limit)
+{
+    scrollbackByteLimit->setValue(static_cast<int>(limit / 1048576));
+}
+
+void
+ConfigureView::setScrollbackRowLimit(int limit)
+{
+    scrollbackRowLimit->setValue(limit);
+}
+
@@ -22,9 +22,14 @@
 
 #include <QtWidgets/QCheckBox>
 #include <QtWidgets/QComboBox>
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QListWidget>
 #include <QtWidgets/QPushButton>
+#include <QtWidgets/QSpinBox>
 
 #include "designerview.h"
+#include "messagefilter.h"
+#include "messagefiltereditor.h"
 
 class ConfigureView: public DesignerView {
 
@@ -54,6 +59,18 @@ public slots:
     void
     removeOutputPort(int index);
 
+    void
+    setCaptureByteLimit(int limit);
+
+    void
+    setCaptureEventLimit(int limit);
+
+    void
+    setCaptureStatus(const QString &status);
+
+    void
+    setDeliveryRate(int rate);
+
     void
     setDriver(int index);
 
@@ -67,13 +84,46 @@ public slots:
     setIgnoreTimeEvents(bool ignore);
 
     void
-    setInputPort(int index);
+    setInputPortOpen(int index, bool open);
+
+    void
+    setMessageFilter(const MessageFilter &filter);
 
     void
     setOutputPort(int index);
 
+    void
+    setOverflowPolicy(int policy);
+
+    void
+    setRealTimeCpu(int cpu);
+
+    void
+    setRealTimeEnabled(bool enabled);
+
+    void
+    setRealTimePolicy(int policy);
+
+    void
+    setRealTimePriority(int priority);
+
+    void
+    setScrollbackByteLimit(qint64 limit);
+
+    void
+    setScrollbackRowLimit(int limit);
+
 signals:
 
+    void
+    captureByteLimitChangeRequest(int limit);
+
+    void
+    captureEventLimitChangeRequest(int limit);
+
+    void
+    deliveryRateChangeRequest(int rate);
+
     void
     driverChangeRequest(int index);
 
@@ -87,31 +137,73 @@ signals:
     ignoreTimeEventsChangeRequest(bool ignore);
 
     void
-    inputPortChangeRequest(int index);
+    inputPortOpenChangeRequest(int index, bool open);
+
+    void
+    messageFilterChangeRequest(const MessageFilter &filter);
 
     void
     outputPortChangeRequest(int index);
 
+    void
+    overflowPolicyChangeRequest(int policy);
+
+    void
+    realTimeCpuChangeRequest(int cpu);
+
+    void
+    realTimeEnabledChangeRequest(bool enabled);
+
+    void
+    realTimePolicyChangeRequest(int policy);
+
+    void
+    realTimePriorityChangeRequest(int priority);
+
+    void
+    scrollbackByteLimitChangeRequest(qint64 limit);
+
+    void
+    scrollbackRowLimitChangeRequest(int limit);
+
 private slots:
 
+    void
+    handleCaptureByteLimitChange(int kilobytes);
+
     void
     handleDriverActivation(int index);
 
     void
-    handleInputPortActivation(int index);
+    handleInputPortChange(QListWidgetItem *item);
 
     void
     handleOutputPortActivation(int index);
 
+    void
+    handleScrollbackByteLimitChange(int megabytes);
+
 private:
 
+    QSpinBox *captureByteLimit;
+    QSpinBox *captureEventLimit;
+    QLabel *captureStatus;
     QPushButton *closeButton;
+    QSpinBox *deliveryRate;
     QComboBox *driver;
     QCheckBox *ignoreActiveSensingEvents;
     QCheckBox *ignoreSystemExclusiveEvents;
     QCheckBox *ignoreTimeEvents;
-    QComboBox *inputPort;
+    QListWidget *inputPorts;
+    MessageFilterEditor *messageFilterEditor;
     QComboBox *outputPort;
+    QComboBox *overflowPolicy;
+    QSpinBox *realTimeCpu;
+    QCheckBox *realTimeEnabled;
+    QComboBox *realTimePolicy;
+    QSpinBox *realTimePriority;
+    QSpinBox *scrollbackByteLimit;
+    QSpinBox *scrollbackRowLimit;
 
 };
 
@@ -17,26 +17,33 @@
  * Ave, Cambridge, MA 02139, USA.
  */
 
-#include <cassert>
+#include <cstring>
 
 #include <QtCore/QDebug>
 
+#include "capturefile.h"
 #include "controller.h"
 #include "error.h"
+#include "hexparser.h"
+#include "messagedecoder.h"
 #include "util.h"
 
-// Static data
+// Static functions
 
-const int statusLengths[0x80] = {
-    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
-    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
-    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
-    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
-    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
-    0, 2, 3, 2, -1, -1, 1, -1, 1, 1, 1, 1, 1, -1, 1, 1
-};
+QString
+Controller::getRealTimeResultString(RealTimeResult result)
+{
+    switch (result) {
+    case REALTIMERESULT_NONE:
+        return tr("pending");
+    case REALTIMERESULT_SUCCEEDED:
+        return tr("succeeded");
+    case REALTIMERESULT_FAILED:
+        return tr("failed");
+    default:
+        return tr("unsupported");
+    }
+}
 
 // Class definition
 
@@ -51,6 +58,29 @@ Controller::Controller(Application &application, QObject *parent):
     connect(&aboutView, SIGNAL(closeRequest()),
             &aboutView, SLOT(hide()));
 
+    // Setup capture loader
+    connect(&captureLoader, SIGNAL(loadFailed(const QString &)),
+            &errorView, SLOT(setMessage(const QString &)));
+    connect(&captureLoader, SIGNAL(loadFailed(const QString &)),
+            &errorView, SLOT(show()));
+    connect(&captureLoader, SIGNAL(loadFailed(const QString &)),
+            SLOT(addHeldMessages()));
+    connect(&captureLoader, SIGNAL(loadFinished()),
+            SLOT(addHeldMessages()));
+    connect(&captureLoader,
+            SIGNAL(pagesLoaded(MessageTableModel::PageBuilder &)),
+            SLOT(handleLoadedPages(MessageTableModel::PageBuilder &)),
+            Qt::DirectConnection);
+
+    // Setup clock view
+    clockView.setClockAnalysisEnabled(engine.getClockAnalysisEnabled());
+    connect(&clockView, SIGNAL(clockAnalysisEnabledChangeRequest(bool)),
+            &engine, SLOT(setClockAnalysisEnabled(bool)));
+    connect(&clockView, SIGNAL(closeRequest()),
+            &clockView, SLOT(hide()));
+    connect(&clockView, SIGNAL(resetRequest()),
+            &engine, SLOT(resetClockAnalysis()));
+
     // Setup configure view
     int driverCount = engine.getDriverCount();
     if (! driverCount) {
@@ -61,16 +91,32 @@ Controller::Controller(Application &application, QObject *parent):
     }
     int driver = engine.getDriver();
     int outputPort = engine.getOutputPort();
+    configureView.setCaptureByteLimit(engine.getCaptureByteLimit());
+    configureView.setCaptureEventLimit(engine.getCaptureEventLimit());
+    configureView.setDeliveryRate(engine.getDeliveryRate());
     configureView.setDriver(driver);
-    configureView.setInputPort(engine.getInputPort());
     configureView.setIgnoreActiveSensingEvents
         (engine.getIgnoreActiveSensingEvents());
     configureView.setIgnoreSystemExclusiveEvents
         (engine.getIgnoreSystemExclusiveEvents());
     configureView.setIgnoreTimeEvents(engine.getIgnoreTimeEvents());
+    configureView.setMessageFilter(engine.getMessageFilter());
     configureView.setOutputPort(outputPort);
+    configureView.setOverflowPolicy(engine.getOverflowPolicy());
+    configureView.setRealTimeCpu(engine.getRealTimeCpu());
+    configureView.setRealTimeEnabled(engine.getRealTimeEnabled());
+    configureView.setRealTimePolicy(engine.getRealTimePolicy());
+    configureView.setRealTimePriority(engine.getRealTimePriority());
+    configureView.setScrollbackByteLimit(mainView.getScrollbackByteLimit());
+    configureView.setScrollbackRowLimit(mainView.getScrollbackRowLimit());
+    connect(&configureView, SIGNAL(captureByteLimitChangeRequest(int)),
+            &engine, SLOT(setCaptureByteLimit(int)));
+    connect(&configureView, SIGNAL(captureEventLimitChangeRequest(int)),
+            &engine, SLOT(setCaptureEventLimit(int)));
     connect(&configureView, SIGNAL(closeRequest()),
             &configureView, SLOT(hide()));
+    connect(&configureView, SIGNAL(deliveryRateChangeRequest(int)),
+            &engine, SLOT(setDeliveryRate(int)));
     connect(&configureView, SIGNAL(driverChangeRequest(int)),
             &engine, SLOT(setDriver(int)));
     connect(&configureView,
@@ -81,27 +127,68 @@ Controller::Controller(Application &application, QObject *parent):
             &engine, SLOT(setIgnoreSystemExclusiveEvents(bool)));
     connect(&configureView, SIGNAL(ignoreTimeEventsChangeRequest(bool)),
             &engine, SLOT(setIgnoreTimeEvents(bool)));
-    connect(&configureView, SIGNAL(inputPortChangeRequest(int)),
-            &engine, SLOT(setInputPort(int)));
+    connect(&configureView, SIGNAL(inputPortOpenChangeRequest(int, bool)),
+            &engine, SLOT(setInputPortOpen(int, bool)));
+    connect(&configureView,
+            SIGNAL(messageFilterChangeRequest(const MessageFilter &)),
+            &engine, SLOT(setMessageFilter(const MessageFilter &)));
     connect(&configureView, SIGNAL(outputPortChangeRequest(int)),
             &engine, SLOT(setOutputPort(int)));
+    connect(&configureView, SIGNAL(overflowPolicyChangeRequest(int)),
+            &engine, SLOT(setOverflowPolicy(int)));
+    connect(&configureView, SIGNAL(realTimeCpuChangeRequest(int)),
+            &engine, SLOT(setRealTimeCpu(int)));
+    connect(&configureView, SIGNAL(realTimeEnabledChangeRequest(bool)),
+            &engine, SLOT(setRealTimeEnabled(bool)));
+    connect(&configureView, SIGNAL(realTimePolicyChangeRequest(int)),
+            &engine, SLOT(setRealTimePolicy(int)));
+    connect(&configureView, SIGNAL(realTimePriorityChangeRequest(int)),
+            &engine, SLOT(setRealTimePriority(int)));
+    connect(&configureView, SIGNAL(scrollbackByteLimitChangeRequest(qint64)),
+            &mainView, SLOT(setScrollbackByteLimit(qint64)));
+    connect(&configureView, SIGNAL(scrollbackRowLimitChangeRequest(int)),
+            &mainView, SLOT(setScrollbackRowLimit(int)));
 
     // Setup error view
     connect(&errorView, SIGNAL(closeRequest()),
             &errorView, SLOT(hide()));
 
+    // Setup filter view
+    filterView.setFilter(mainView.getDisplayFilter());
+    filterView.setFilterEnabled(mainView.getDisplayFilterEnabled());
+    connect(&filterView, SIGNAL(closeRequest()),
+            &filterView, SLOT(hide()));
+    connect(&filterView, SIGNAL(filterChangeRequest(const MessageFilter &)),
+            &filterView, SLOT(setFilter(const MessageFilter &)));
+    connect(&filterView, SIGNAL(filterChangeRequest(const MessageFilter &)),
+            &mainView, SLOT(setDisplayFilter(const MessageFilter &)));
+    connect(&filterView, SIGNAL(filterEnabledChangeRequest(bool)),
+            &mainView, SLOT(setDisplayFilterEnabled(bool)));
+
     // Setup main view
     mainView.setMessageSendEnabled((driver != -1) && (outputPort != -1));
     connect(&mainView, SIGNAL(aboutRequest()),
             &aboutView, SLOT(show()));
     connect(&mainView, SIGNAL(addMessageRequest()),
             &messageView, SLOT(show()));
+    connect(&mainView, SIGNAL(clearMessagesRequest()),
+            &captureLoader, SLOT(cancel()));
     connect(&mainView, SIGNAL(clearMessagesRequest()),
             &mainView, SLOT(clearMessages()));
+    connect(&mainView, SIGNAL(clearMessagesRequest()),
+            SLOT(clearHeldMessages()));
+    connect(&mainView, SIGNAL(clockAnalysisRequest()),
+            &clockView, SLOT(show()));
     connect(&mainView, SIGNAL(configureRequest()),
             &configureView, SLOT(show()));
     connect(&mainView, SIGNAL(closeRequest()),
             &application, SLOT(quit()));
+    connect(&mainView, SIGNAL(displayFilterRequest()),
+            &filterView, SLOT(show()));
+    connect(&mainView, SIGNAL(loadCaptureRequest(const QString &)),
+            SLOT(handleCaptureLoad(const QString &)));
+    connect(&mainView, SIGNAL(saveCaptureRequest(const QString &)),
+            SLOT(handleCaptureSave(const QString &)));
 
     // Setup message view
     connect(&messageView, SIGNAL(closeRequest()),
@@ -112,8 +199,16 @@ Controller::Controller(Application &application, QObject *parent):
             SLOT(handleMessageSend(const QString &)));
 
     // Setup engine
-    connect(&engine, SIGNAL(messageReceived(quint64, const QByteArray &)),
-            SLOT(handleReceivedMessage(quint64, const QByteArray &)));
+    connect(&engine, SIGNAL(messagesReceived(const EventBlock &)),
+            SLOT(handleReceivedMessages(const EventBlock &)));
+    connect(&engine, SIGNAL(captureByteLimitChanged(int)),
+            &configureView, SLOT(setCaptureByteLimit(int)));
+    connect(&engine, SIGNAL(captureEventLimitChanged(int)),
+            &configureView, SLOT(setCaptureEventLimit(int)));
+    connect(&engine, SIGNAL(clockAnalysisEnabledChanged(bool)),
+            &clockView, SLOT(setClockAnalysisEnabled(bool)));
+    connect(&engine, SIGNAL(deliveryRateChanged(int)),
+            &configureView, SLOT(setDeliveryRate(int)));
     connect(&engine, SIGNAL(driverChanged(int)),
             &configureView, SLOT(setDriver(int)));
     connect(&engine, SIGNAL(driverChanged(int)),
@@ -126,12 +221,12 @@ Controller::Controller(Application &application, QObject *parent):
             &configureView, SLOT(setIgnoreTimeEvents(bool)));
     connect(&engine, SIGNAL(inputPortAdded(int, QString)),
             &configureView, SLOT(addInputPort(int, QString)));
-    connect(&engine, SIGNAL(inputPortChanged(int)),
-            &configureView, SLOT(setInputPort(int)));
-    connect(&engine, SIGNAL(inputPortChanged(int)),
-            SLOT(handleDriverChange()));
+    connect(&engine, SIGNAL(inputPortOpenChanged(int, bool)),
+            &configureView, SLOT(setInputPortOpen(int, bool)));
     connect(&engine, SIGNAL(inputPortRemoved(int)),
             &configureView, SLOT(removeInputPort(int)));
+    connect(&engine, SIGNAL(messageFilterChanged(const MessageFilter &)),
+            &configureView, SLOT(setMessageFilter(const MessageFilter &)));
     connect(&engine, SIGNAL(outputPortAdded(int, QString)),
             &configureView, SLOT(addOutputPort(int, QString)));
     connect(&engine, SIGNAL(outputPortChanged(int)),
@@ -140,6 +235,27 @@ Controller::Controller(Application &application, QObject *parent):
             SLOT(handleDriverChange()));
     connect(&engine, SIGNAL(outputPortRemoved(int)),
             &configureView, SLOT(removeOutputPort(int)));
+    connect(&engine, SIGNAL(overflowPolicyChanged(int)),
+            &configureView, SLOT(setOverflowPolicy(int)));
+    connect(&engine, SIGNAL(realTimeCpuChanged(int)),
+            &configureView, SLOT(setRealTimeCpu(int)));
+    connect(&engine, SIGNAL(realTimeEnabledChanged(bool)),
+            &configureView, SLOT(setRealTimeEnabled(bool)));
+    connect(&engine, SIGNAL(realTimePolicyChanged(int)),
+            &configureView, SLOT(setRealTimePolicy(int)));
+    connect(&engine, SIGNAL(realTimePriorityChanged(int)),
+            &configureView, SLOT(setRealTimePriority(int)));
+
+    // The capture status is updated by the capture threads, so it's polled.
+    connect(&captureStatusTimer, SIGNAL(timeout()),
+            SLOT(updateCaptureStatus()));
+    captureStatusTimer.start(1000);
+
+    // So are the clock statistics, but only while they're shown.
+    connect(&clockViewTimer, SIGNAL(timeout()), SLOT(updateClockView()));
+    connect(&clockView, SIGNAL(visibilityChanged(bool)),
+            SLOT(updateClockView()));
+    clockViewTimer.setInterval(250);
 
     // Setup application
     connect(&application, SIGNAL(eventError(QString)),
@@ -152,347 +268,192 @@ Controller::~Controller()
 {
     // Disconnect engine signals handled by the controller before the engine is
     // deleted.
-    disconnect(&engine, SIGNAL(messageReceived(quint64, const QByteArray &)),
-               this, SLOT(handleReceivedMessage(quint64, const QByteArray &)));
+    disconnect(&engine, SIGNAL(messagesReceived(const EventBlock &)),
+               this, SLOT(handleReceivedMessages(const EventBlock &)));
     disconnect(&engine, SIGNAL(driverChanged(int)),
                this, SLOT(handleDriverChange()));
-    disconnect(&engine, SIGNAL(inputPortChanged(int)),
-               this, SLOT(handleDriverChange()));
     disconnect(&engine, SIGNAL(outputPortChanged(int)),
                this, SLOT(handleDriverChange()));
 }
 
-QString
-Controller::getGenericDataDescription(const QByteArray &message, int lastIndex)
+void
+Controller::addHeldMessages()
 {
-    assert((lastIndex >= -1) && (lastIndex < message.count()));
-    if (lastIndex == -1) {
-        lastIndex = message.count() - 1;
+    const quint8 *data = reinterpret_cast<const quint8 *>
+        (heldData.constData());
+    for (int i = heldMessages.count() - 1; i >= 0; i--) {
+        heldMessages[i].data = data + heldDataOffsets[i];
     }
-
-    QStringList dataParts;
-    for (int i = 1; i <= lastIndex; i++) {
-        dataParts += QString("%1").
-            arg(static_cast<uint>(message[i]), 2, 16, QChar('0'));
-    }
-    dataParts += tr("(%1 bytes)").arg(lastIndex);
-    return dataParts.join(" ");
+    mainView.addReceivedMessages(heldMessages);
+    clearHeldMessages();
 }
 
 void
-Controller::handleDriverChange()
+Controller::clearHeldMessages()
 {
-    mainView.setMessageSendEnabled((engine.getDriver() != -1) &&
-                                   (engine.getOutputPort() != -1));
+    heldData.clear();
+    heldDataOffsets.clear();
+    heldMessages.clear();
 }
 
 void
-Controller::handleMessageSend(const QString &message)
+Controller::handleCaptureLoad(const QString &path)
 {
-    // Convert the message to bytes.
-    QStringList bytes = message.split(' ', QString::SkipEmptyParts);
-    int count = bytes.count();
-    QByteArray msg;
-    for (int i = 0; i < count; i++) {
-        QString byteStr = bytes[i];
-        bool success;
-        uint value = byteStr.toUInt(&success, 16);
-        if ((! success) || (value > 0xff)) {
-            showError(tr("'%1' is not a valid hexadecimal MIDI byte").
-                      arg(byteStr));
-            return;
-        }
-        msg.append(static_cast<char>(static_cast<quint8>(value)));
+    clearHeldMessages();
+    mainView.clearMessages();
+    try {
+        captureLoader.load(path);
+    } catch (Error &e) {
+        showError(e.getMessage());
     }
+}
 
-    // Make sure the bytes represent a valid MIDI message.
-    parseMessage(msg);
-    if (! valid) {
-        showError(tr("The given message is not a valid MIDI message."));
-        return;
+void
+Controller::handleCaptureSave(const QString &path)
+{
+    try {
+        CaptureFile::save(path, mainView.getMessageModel());
+    } catch (Error &e) {
+        showError(e.getMessage());
     }
+}
 
-    // Send the message.
-    quint64 timeStamp = engine.sendMessage(msg);
-    mainView.addSentMessage(timeStamp, statusDescription, dataDescription,
-                            valid);
+void
+Controller::handleDriverChange()
+{
+    mainView.setMessageSendEnabled((engine.getDriver() != -1) &&
+                                   (engine.getOutputPort() != -1));
 }
 
 void
-Controller::handleReceivedMessage(quint64 timeStamp, const QByteArray &message)
+Controller::handleLoadedPages(MessageTableModel::PageBuilder &pages)
 {
-    parseMessage(message);
-    mainView.addReceivedMessage(timeStamp, statusDescription, dataDescription,
-                                valid);
+    mainView.addLoadedPages(pages);
 }
 
 void
-Controller::parseMessage(const QByteArray &message)
+Controller::handleMessageSend(const QString &message)
 {
-    // Make sure we have an actual message.
-    int length = message.count();
-    if (! length) {
-        dataDescription = "";
-        statusDescription = tr("empty message");
-        valid = false;
+    // Convert the text to messages.
+    MessageBatch batch;
+    try {
+        batch = HexParser::parse(message);
+    } catch (Error &e) {
+        showError(e.getMessage());
         return;
     }
 
-    // Validate status byte.
-    quint8 status = static_cast<quint8>(message[0]);
-    if (status < 0x80) {
-        dataDescription = getGenericDataDescription(message);
-        statusDescription = tr("%1 (invalid status)").
-            arg(static_cast<uint>(status), 2, 16, QChar('0'));
-        valid = false;
+    // Make sure the bytes represent valid MIDI messages.
+    int count = batch.getCount();
+    if (! count) {
+        showError(tr("The given message is not a valid MIDI message."));
         return;
     }
+    for (int i = 0; i < count; i++) {
+        DecodedMessage decoded =
+            decodeMessage(batch.getMessage(i),
+                          static_cast<quint32>(batch.getMessageLength(i)));
+        if (! decoded.isValid()) {
+            if (count == 1) {
+                showError(tr("The given message is not a valid MIDI "
+                             "message."));
+            } else {
+                showError(tr("Message %1 of %2 is not a valid MIDI "
+                             "message.").arg(i + 1).arg(count));
+            }
+            return;
+        }
+    }
 
-    // Validate length and data.
-    QString errorMessage;
-    int expectedLength = statusLengths[status - 0x80];
-    int lastDataIndex;
-    switch (expectedLength) {
-
-    case -1:
-        dataDescription = getGenericDataDescription(message);
-        statusDescription = tr("%1 (undefined status)").
-            arg(static_cast<uint>(status), 2, 16, QChar('0'));
-        valid = false;
-        return;
+    // Send the messages.
+    engine.sendMessages(batch, sentTimeStamps);
+    mainView.addSentMessages(engine.getOutputPortName(engine.getOutputPort()),
+                             batch, sentTimeStamps);
+}
 
-    case 0:
-        if (length == 1) {
-            dataDescription = "";
-            statusDescription = tr("System Exclusive (no data)");
-            valid = false;
-            return;
+void
+Controller::handleReceivedMessages(const EventBlock &block)
+{
+    // Rows are added straight from the block, without copying the messages
+    // first.  Engine port ids are mapped to the message list's port ids the
+    // first time they're seen.
+    int count = block.getCount();
+    for (int i = 0; i < count; i++) {
+        const MidiEvent &event = block.getEvent(i);
+        while (portIds.count() <= event.port) {
+            quint16 enginePort = static_cast<quint16>(portIds.count());
+            portIds.append(mainView.getPortId(engine.getPortName(enginePort)));
+            nextSequences.append(0);
         }
-        if (static_cast<quint8>(message[length - 1]) != 0xf7) {
-            dataDescription = getGenericDataDescription(message);
-            statusDescription = tr("System Exclusive (end not found)");
-            valid = false;
-            return;
+        quint16 port = portIds[event.port];
+
+        // A gap in a port's sequence numbers means that messages were dropped
+        // because the capture buffer was full.  The gap is shown as a row of
+        // its own, where the missing messages would have been.
+        quint32 &nextSequence = nextSequences[event.port];
+        quint32 dropped = event.sequence - nextSequence;
+        nextSequence = event.sequence + 1;
+        if (dropped) {
+            receivedMessages.append(MainView::MessageRef());
+            MainView::MessageRef &gap = receivedMessages.last();
+            gap.annotation.kind = Annotation::KIND_NONE;
+            gap.data = 0;
+            gap.dataSize = 0;
+            gap.length = dropped;
+            gap.port = port;
+            gap.spillOffset = 0;
+            gap.timeStamp = event.timeStamp;
+            gap.totalDropped = engine.getDroppedCount(event.port);
+            gap.type = MessageTableModel::MESSAGETYPE_DROPPED;
         }
-        lastDataIndex = length - 2;
-        break;
 
-    default:
-        if (length != expectedLength) {
-            dataDescription = getGenericDataDescription(message);
-            statusDescription = tr("%1 (incorrect length)").
-                arg(static_cast<uint>(status), 2, 16, QChar('0'));
-            valid = false;
-            return;
+        receivedMessages.append(MainView::MessageRef());
+        MainView::MessageRef &message = receivedMessages.last();
+        message.data = block.getData(event);
+        if (event.flags & MidiEvent::FLAG_SPILLED) {
+
+            // The rows of spilled messages keep the spill file they were
+            // written to, so that they can be read back later.
+            message.annotation.kind = Annotation::KIND_NONE;
+            message.dataSize = MidiEvent::PREVIEW_SIZE;
+            message.spillFile = engine.getSpillFile(event.port);
+            std::memcpy(&message.spillOffset,
+                        message.data + MidiEvent::PREVIEW_SIZE,
+                        sizeof(message.spillOffset));
+            message.type = MessageTableModel::MESSAGETYPE_SPILLED;
+        } else {
+
+            // Messages are annotated here, in the order they were received,
+            // since annotations depend on the messages before them.
+            message.annotation =
+                annotator.annotate(event.port,
+                                   decodeMessage(message.data, event.length));
+            message.dataSize = event.length;
+            message.spillOffset = 0;
+            message.type = MessageTableModel::MESSAGETYPE_RECEIVED;
         }
-        lastDataIndex = length - 1;
+        message.length = event.length;
+        message.port = port;
+        message.timeStamp = event.timeStamp;
+        message.totalDropped = 0;
     }
-
-    // Validate data bytes.
-    for (int i = 1; i <= lastDataIndex; i++) {
-        if (static_cast<quint8>(message[i]) >= 0x80) {
-            dataDescription = getGenericDataDescription(message);
-            statusDescription = tr("%1 (invalid data)").
-                arg(static_cast<uint>(status), 2, 16, QChar('0'));
-            valid = false;
-            return;
+    if (captureLoader.isLoading()) {
+
+        // The data is copied, since the block is reused.  Pointers to the
+        // copies are set when the messages are added.
+        for (int i = 0; i < receivedMessages.count(); i++) {
+            const MainView::MessageRef &message = receivedMessages[i];
+            heldDataOffsets.append(heldData.size());
+            heldData.append(reinterpret_cast<const char *>(message.data),
+                            static_cast<int>(message.dataSize));
         }
+        heldMessages += receivedMessages;
+    } else {
+        mainView.addReceivedMessages(receivedMessages);
     }
 
-    // Convert message to user-friendly strings.
-    QString s;
-    int value;
-    valid = true;
-    switch (status & 0xf0) {
-
-    case 0x80:
-        dataDescription = tr("Note: %1, Velocity: %2").
-            arg(getMIDINoteString(static_cast<quint8>(message[1]))).
-            arg(static_cast<quint8>(message[2]));
-        statusDescription = tr("Note Off, Channel %1").arg((status & 0xf) + 1);
-        break;
-
-    case 0x90:
-        dataDescription = tr("Note: %1, Velocity: %2").
-            arg(getMIDINoteString(static_cast<quint8>(message[1]))).
-            arg(static_cast<quint8>(message[2]));
-        statusDescription = tr("Note On, Channel %1").arg((status & 0xf) + 1);
-        break;
-
-    case 0xa0:
-        dataDescription = tr("Note: %1, Pressure: %2").
-            arg(getMIDINoteString(static_cast<quint8>(message[1]))).
-            arg(static_cast<quint8>(message[2]));
-        statusDescription = tr("Aftertouch, Channel %1").
-            arg((status & 0xf) + 1);
-        break;
-
-    case 0xb0:
-        dataDescription = tr("Controller: %1, Value: %2").
-            arg(getMIDIControlString(static_cast<quint8>(message[1]))).
-            arg(static_cast<quint8>(message[2]));
-        statusDescription = tr("Controller, Channel %1").
-            arg((status & 0xf) + 1);
-        break;
-
-    case 0xc0:
-        dataDescription = tr("Number: %1").arg(static_cast<quint8>(message[1]));
-        statusDescription = tr("Program Change, Channel %1").
-            arg((status & 0xf) + 1);
-        break;
-
-    case 0xd0:
-        dataDescription = tr("Pressure: %1").
-            arg(static_cast<quint8>(message[1]));
-        statusDescription = tr("Channel Pressure, Channel %1").
-            arg((status & 0xf) + 1);
-        break;
-
-    case 0xe0:
-        dataDescription = tr("Value: %1").
-            arg((((static_cast<qint16>(message[2])) << 7) |
-                 (static_cast<qint16>(message[1]))) - 0x2000);
-        statusDescription = tr("Pitch Wheel, Channel %1").
-            arg((status & 0xf) + 1);
-        break;
-
-    case 0xf0:
-        switch (status & 0xf) {
-
-        case 0x0:
-            dataDescription = getGenericDataDescription(message, lastDataIndex);
-            statusDescription = tr("System Exclusive");
-            break;
-
-        case 0x1:
-            value = message[0] & 0xf;
-            switch (message[0] & 0x70) {
-
-            case 0x00:
-                dataDescription = tr("Frames Low Nibble: %1").arg(value);
-                break;
-
-            case 0x10:
-                dataDescription = tr("Frames High Nibble: %1").arg(value);
-                break;
-
-            case 0x20:
-                dataDescription = tr("Seconds Low Nibble: %1").arg(value);
-                break;
-
-            case 0x30:
-                dataDescription = tr("Seconds High Nibble: %1").arg(value);
-                break;
-
-            case 0x40:
-                dataDescription = tr("Minutes Low Nibble: %1").arg(value);
-                break;
-
-            case 0x50:
-                dataDescription = tr("Minutes High Nibble: %1").arg(value);
-                break;
-
-            case 0x60:
-                dataDescription = tr("Hours Low Nibble: %1").arg(value);
-                break;
-
-            case 0x70:
-                switch ((value & 0x6) >> 1) {
-
-                case 0:
-                    s = tr("24 fps");
-                    break;
-
-                case 1:
-                    s = tr("25 fps");
-                    break;
-
-                case 2:
-                    s = tr("30 fps (drop-frame)");
-                    break;
-
-                case 3:
-                    s = tr("30 fps");
-                    break;
-
-                default:
-                    // We shouldn't get here.
-                    assert(false);
-                }
-                dataDescription = tr("Hours High Nibble: %1, SMPTE Type: %2").
-                    arg(value & 1).arg(s);
-                break;
-
-            default:
-                // We shouldn't get here.
-                assert(false);
-            }
-            statusDescription = tr("MTC Quarter Frame");
-            break;
-
-        case 0x2:
-            dataDescription = tr("MIDI Beat: %1").
-                arg(((static_cast<qint16>(message[2])) << 7) |
-                    (static_cast<qint16>(message[1])));
-            statusDescription = tr("Song Position Pointer");
-            break;
-
-        case 0x3:
-            dataDescription = tr("Song Number: %1").
-                arg(static_cast<quint8>(message[1]));
-            statusDescription = tr("Song Select");
-            break;
-
-        case 0x6:
-            dataDescription = "";
-            statusDescription = tr("Tune Request");
-            break;
-
-        case 0x8:
-            dataDescription = "";
-            statusDescription = tr("MIDI Clock");
-            break;
-
-        case 0x9:
-            dataDescription = "";
-            statusDescription = tr("MIDI Tick");
-            break;
-
-        case 0xa:
-            dataDescription = "";
-            statusDescription = tr("MIDI Start");
-            break;
-
-        case 0xb:
-            dataDescription = "";
-            statusDescription = tr("MIDI Continue");
-            break;
-
-        case 0xc:
-            dataDescription = "";
-            statusDescription = tr("MIDI Stop");
-            break;
-
-        case 0xe:
-            dataDescription = "";
-            statusDescription = tr("Active Sense");
-            break;
-
-        case 0xf:
-            dataDescription = "";
-            statusDescription = tr("Reset");
-            break;
-
-        default:
-            // We shouldn't get here.
-            assert(false);
-        }
-        break;
-
-    default:
-        // We shouldn't get here.
-        assert(false);
-    }
+    // The messages aren't kept, so that they don't keep spill files open.
+    receivedMessages.resize(0);
 }
 
 void
@@ -508,3 +469,59 @@ Controller::showError(const QString &message)
     errorView.setMessage(message);
     errorView.show();
 }
+
+void
+Controller::updateCaptureStatus()
+{
+    QStringList lines;
+    int count = engine.getInputPortCount();
+    for (int i = 0; i < count; i++) {
+        if (! engine.isInputPortOpen(i)) {
+            continue;
+        }
+        QString line = engine.getInputPortName(i);
+        if (engine.getRealTimeEnabled()) {
+            RealTimeStatus status = engine.getRealTimeStatus(i);
+            line += tr(": scheduling %1, CPU affinity %2, memory lock %3").
+                arg(getRealTimeResultString(status.scheduling),
+                    getRealTimeResultString(status.affinity),
+                    getRealTimeResultString(status.memoryLock));
+        }
+        LatencySnapshot latency = engine.getWakeupLatency(i).getSnapshot();
+        if (latency.count) {
+            line += tr("\nWakeup latency: mean %1 ms, 99% below %2 ms, "
+                       "maximum %3 ms").
+                arg(latency.getMean() / 1000.0, 0, 'f', 3).
+                arg(latency.getPercentile(99) / 1000.0, 0, 'f', 3).
+                arg(latency.maximum / 1000.0, 0, 'f', 3);
+        } else {
+            line += tr("\nWakeup latency: not measured yet");
+        }
+        lines.append(line);
+    }
+    configureView.setCaptureStatus(lines.isEmpty() ?
+                                   tr("No input ports are open.") :
+                                   lines.join("\n\n"));
+}
+
+void
+Controller::updateClockView()
+{
+    if (! clockView.isVisible()) {
+        clockViewTimer.stop();
+        return;
+    }
+    QStringList ports;
+    QVector<ClockStatistics> statistics;
+    int count = engine.getInputPortCount();
+    for (int i = 0; i < count; i++) {
+        if (engine.isInputPortOpen(i)) {
+            ports.append(engine.getInputPortName(i));
+            statistics.append(engine.getClockAnalyzer(i).getStatistics());
+        }
+    }
+    clockView.setStatistics(ports, statistics);
+    if (! clockViewTimer.isActive()) {
+        clockViewTimer.start();
+    }
+}
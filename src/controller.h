@@ -20,12 +20,20 @@
 #ifndef __CONTROLLER_H__
 #define __CONTROLLER_H__
 
+#include <QtCore/QByteArray>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+
 #include "aboutview.h"
 #include "application.h"
+#include "captureloader.h"
+#include "clockview.h"
 #include "configureview.h"
 #include "engine.h"
 #include "errorview.h"
+#include "filterview.h"
 #include "mainview.h"
+#include "messageannotator.h"
 #include "messageview.h"
 
 class Controller: public QObject {
@@ -44,36 +52,69 @@ public:
 
 private slots:
 
+    void
+    addHeldMessages();
+
+    void
+    clearHeldMessages();
+
+    void
+    handleCaptureLoad(const QString &path);
+
+    void
+    handleCaptureSave(const QString &path);
+
     void
     handleDriverChange();
 
     void
-    handleMessageSend(const QString &message);
+    handleLoadedPages(MessageTableModel::PageBuilder &pages);
 
     void
-    handleReceivedMessage(quint64 timeStamp, const QByteArray &message);
+    handleMessageSend(const QString &message);
 
-private:
+    void
+    handleReceivedMessages(const EventBlock &block);
 
-    QString
-    getGenericDataDescription(const QByteArray &message, int lastIndex=-1);
+    void
+    updateCaptureStatus();
 
     void
-    parseMessage(const QByteArray &message);
+    updateClockView();
+
+private:
+
+    static QString
+    getRealTimeResultString(RealTimeResult result);
 
     void
     showError(const QString &message);
 
     AboutView aboutView;
+    MessageAnnotator annotator;
     Application &application;
+    CaptureLoader captureLoader;
+    QTimer captureStatusTimer;
+    ClockView clockView;
+    QTimer clockViewTimer;
     ConfigureView configureView;
-    QString dataDescription;
     Engine engine;
     ErrorView errorView;
+    FilterView filterView;
+
+    // Received messages are held back while a capture file is loading, so
+    // that they're added after the file's messages.  The held messages'
+    // data is copied to `heldData`, at the offsets in `heldDataOffsets`.
+    QByteArray heldData;
+    QVector<int> heldDataOffsets;
+    QVector<MainView::MessageRef> heldMessages;
+
     MainView mainView;
     MessageView messageView;
-    QString statusDescription;
-    bool valid;
+    QVector<quint32> nextSequences;
+    QVector<quint16> portIds;
+    QVector<MainView::MessageRef> receivedMessages;
+    QVector<quint64> sentTimeStamps;
 
 };
 
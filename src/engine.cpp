@@ -17,28 +17,36 @@
  * Ave, Cambridge, MA 02139, USA.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstring>
 
+#include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
+#include <QtCore/QHash>
 
 #include "engine.h"
 #include "error.h"
 
-#if QT_VERSION >= 0x040700
-#include <QtCore/QDateTime>
-#else
-#include <cerrno>
-#include <cstring>
-#include <sys/time.h>
-#endif
+// Static data
+
+const quint8 activeSensingStatuses[] = { 0xfe };
+const quint8 systemExclusiveStatuses[] = { 0xf0 };
+const quint8 timeStatuses[] = { 0xf1, 0xf8, 0xf9 };
 
 // Static functions
 
 void
 Engine::handleMidiInput(double timeStamp, std::vector<unsigned char> *message,
-                        void *engine)
+                        void *capture)
 {
-    static_cast<Engine *>(engine)->handleMidiInput(timeStamp, *message);
+    // While the flag is clear, the callback isn't using a filter, and will
+    // check the filter generation before it uses one again.
+    Capture *c = static_cast<Capture *>(capture);
+    c->inCallback.store(1);
+    c->engine->handleMidiInput(*c, timeStamp, *message);
+    c->inCallback.storeRelease(0);
 }
 
 // Class definition
@@ -80,17 +88,209 @@ Engine::Engine(QObject *parent):
         driverAPIs.append(api);
     }
 
+    // Ports are only left out of the port lists if they belong to this
+    // instance, so the client name is unique to the instance.  Other
+    // instances, and their virtual ports, can still be captured from.
+    clientName = QString("midisnoop-%1").
+        arg(QCoreApplication::applicationPid());
+
+    captureByteLimit = 1048576;
+    captureEventLimit = 4096;
+    clockAnalysisEnabled.store(0);
+    deliveryRate = 60;
     driver = -1;
-    ignoreActiveSensingEvents = true;
-    ignoreSystemExclusiveEvents = true;
-    ignoreTimeEvents = true;
-    inputPort = -1;
+    MessageFilter *filter = new MessageFilter();
+    filter->setStatusAccepted(0xf0, false);
+    filter->setStatusAccepted(0xf1, false);
+    filter->setStatusAccepted(0xf8, false);
+    filter->setStatusAccepted(0xf9, false);
+    filter->setStatusAccepted(0xfe, false);
+    messageFilter.store(filter);
+    messageFilterGeneration.store(0);
     outputPort = -1;
+    overflowPolicy = MessageQueue::OVERFLOWPOLICY_DROP_NEWEST;
+    realTimeCpu.store(-1);
+    realTimeEnabled.store(0);
+    realTimeGeneration.store(0);
+    realTimePolicy.store(REALTIMEPOLICY_FIFO);
+    realTimePriority.store(50);
+    spillThreshold.store(65536);
+
+    // Received messages are queued by the MIDI driver's thread and delivered
+    // from the GUI thread in blocks, `deliveryRate` times per second.
+    connect(&messageTimer, SIGNAL(timeout()), SLOT(deliverMessages()));
+    messageTimer.setInterval(1000 / deliveryRate);
+
+    connect(&portWatcher, SIGNAL(portsChanged()), SLOT(handlePortsChange()));
 }
 
 Engine::~Engine()
 {
     setDriver(-1);
+    freeRetiredFilters();
+    delete messageFilter.load();
+}
+
+void
+Engine::applyRealTimeMode(Capture &capture)
+{
+    // This runs on the capture's callback thread, as scheduling and affinity
+    // can only be changed for the calling thread, and the thread belongs to
+    // the MIDI driver.
+    capture.realTimeGeneration = realTimeGeneration.loadAcquire();
+    if (realTimeEnabled.load()) {
+        RealTimePolicy policy =
+            static_cast<RealTimePolicy>(realTimePolicy.load());
+        capture.schedulingResult.
+            storeRelease(setThreadScheduling(policy, realTimePriority.load()));
+        capture.affinityResult.
+            storeRelease(setThreadAffinity(realTimeCpu.load()));
+    } else if (capture.schedulingResult.load() != REALTIMERESULT_NONE) {
+        setThreadScheduling(REALTIMEPOLICY_NORMAL, 0);
+        setThreadAffinity(-1);
+        capture.affinityResult.storeRelease(REALTIMERESULT_NONE);
+        capture.schedulingResult.storeRelease(REALTIMERESULT_NONE);
+    }
+}
+
+bool
+Engine::areStatusesIgnored(const quint8 *statuses, int count) const
+{
+    const MessageFilter *filter = messageFilter.load();
+    for (int i = 0; i < count; i++) {
+        if (filter->isStatusAccepted(statuses[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+Engine::deliverMessages()
+{
+    // Merge the events queued for each open port into a single block, in
+    // timestamp order.  There are only ever a handful of open ports, so a
+    // linear scan of the queue heads is used to pick the next event.
+    int count = captures.count();
+    for (;;) {
+        Capture *next = 0;
+        const MidiEvent *nextEvent = 0;
+        for (int i = 0; i < count; i++) {
+            Capture *capture = captures[i];
+            const MidiEvent *event = capture->queue.front();
+            if (event && ((! nextEvent) ||
+                          (event->timeStamp < nextEvent->timeStamp))) {
+                next = capture;
+                nextEvent = event;
+            }
+        }
+        if (! next) {
+            break;
+        }
+        messageBlock.append(*nextEvent, next->queue.getData(*nextEvent));
+        if (! next->queue.pop()) {
+
+            // The event was dropped to make room for a newer event while it
+            // was being copied.
+            messageBlock.removeLast();
+        }
+    }
+    if (! messageBlock.isEmpty()) {
+        emit messagesReceived(messageBlock);
+        messageBlock.clear();
+    }
+    if (! retiredFilters.isEmpty()) {
+        freeRetiredFilters();
+    }
+}
+
+int
+Engine::findPort(RtMidi &midi, const QString &name,
+                 const QStringList &names) const
+{
+    // Ports that share a driver name are listed by the driver in a stable
+    // order, and are given numbers in the same order, so a numbered port is
+    // the driver's port with that name and the same rank.
+    if (! portNameParts.contains(name)) {
+        return -1;
+    }
+    const PortName &parts = portNameParts[name];
+    int rank = 0;
+    for (int i = names.count() - 1; i >= 0; i--) {
+        const QString &otherName = names[i];
+        if (portNameParts.contains(otherName)) {
+            const PortName &otherParts = portNameParts[otherName];
+            if ((otherParts.driverName == parts.driverName) &&
+                (otherParts.number < parts.number)) {
+                rank++;
+            }
+        }
+    }
+    QList<unsigned int> indexes;
+    QStringList driverNames = getPortNames(midi, &indexes);
+    for (int i = 0; i < driverNames.count(); i++) {
+        if (driverNames[i] == parts.driverName) {
+            if (! rank) {
+                return static_cast<int>(indexes[i]);
+            }
+            rank--;
+        }
+    }
+    return -1;
+}
+
+void
+Engine::freeRetiredFilters()
+{
+    // Callbacks that have seen a generation no longer use the filters that
+    // were replaced up to that generation.  Ports opened since then start
+    // with the current filter, and callbacks that aren't running check the
+    // generation before they use a filter again, so idle ports don't hold
+    // back retired filters.
+    int generation = messageFilterGeneration.load();
+    for (int i = captures.count() - 1; i >= 0; i--) {
+        const Capture *capture = captures[i];
+        if (capture->inCallback.loadAcquire()) {
+            generation = qMin(generation,
+                              capture->filterGenerationSeen.loadAcquire());
+        }
+    }
+    while ((! retiredFilters.isEmpty()) &&
+           (retiredFilters.first().generation <= generation)) {
+        delete retiredFilters.takeFirst().filter;
+    }
+}
+
+int
+Engine::getCaptureByteLimit() const
+{
+    return captureByteLimit;
+}
+
+int
+Engine::getCaptureEventLimit() const
+{
+    return captureEventLimit;
+}
+
+bool
+Engine::getClockAnalysisEnabled() const
+{
+    return clockAnalysisEnabled.load();
+}
+
+const ClockAnalyzer &
+Engine::getClockAnalyzer(int index) const
+{
+    const Capture *capture = getCapture(index);
+    assert(capture);
+    return capture->clockAnalyzer;
+}
+
+int
+Engine::getDeliveryRate() const
+{
+    return deliveryRate;
 }
 
 int
@@ -112,28 +312,48 @@ Engine::getDriverName(int index) const
     return driverNames[index];
 }
 
+quint32
+Engine::getDroppedCount(quint16 port) const
+{
+    assert(port < portNames.count());
+    quint32 count = portDroppedCounts[port];
+    for (int i = captures.count() - 1; i >= 0; i--) {
+        const Capture *capture = captures[i];
+        if (capture->port == port) {
+            count += capture->queue.getDroppedCount();
+        }
+    }
+    return count;
+}
+
 bool
 Engine::getIgnoreActiveSensingEvents() const
 {
-    return ignoreActiveSensingEvents;
+    return areStatusesIgnored(activeSensingStatuses, 1);
 }
 
 bool
 Engine::getIgnoreSystemExclusiveEvents() const
 {
-    return ignoreSystemExclusiveEvents;
+    return areStatusesIgnored(systemExclusiveStatuses, 1);
 }
 
 bool
 Engine::getIgnoreTimeEvents() const
 {
-    return ignoreTimeEvents;
+    return areStatusesIgnored(timeStatuses, 3);
 }
 
-int
-Engine::getInputPort() const
+Engine::Capture *
+Engine::getCapture(int index) const
 {
-    return inputPort;
+    for (int i = captures.count() - 1; i >= 0; i--) {
+        Capture *capture = captures[i];
+        if (capture->index == index) {
+            return capture;
+        }
+    }
+    return 0;
 }
 
 int
@@ -149,6 +369,25 @@ Engine::getInputPortName(int index) const
     return inputPortNames[index];
 }
 
+const MessageFilter &
+Engine::getMessageFilter() const
+{
+    return *(messageFilter.load());
+}
+
+QString
+Engine::getNumberedPortName(const QString &driverName, int number)
+{
+    QString name = (number == 1) ? driverName :
+        tr("%1 (%2)").arg(driverName).arg(number);
+    if (! portNameParts.contains(name)) {
+        PortName &parts = portNameParts[name];
+        parts.driverName = driverName;
+        parts.number = number;
+    }
+    return name;
+}
+
 int
 Engine::getOutputPort() const
 {
@@ -168,61 +407,326 @@ Engine::getOutputPortName(int index) const
     return outputPortNames[index];
 }
 
-quint64
-Engine::getCurrentTimestamp() const
+int
+Engine::getOverflowPolicy() const
+{
+    return overflowPolicy;
+}
+
+QStringList
+Engine::getPortNames(RtMidi &midi, QList<unsigned int> *indexes) const
 {
+    // Ports that belong to this instance (the ports of open captures, and the
+    // virtual ports) are left out.
+    QStringList names;
+    QString prefix = clientName + ":";
+    unsigned int count = midi.getPortCount();
+    for (unsigned int i = 0; i < count; i++) {
+        QString name = QString::fromStdString(midi.getPortName(i));
+        if (name.isEmpty() || name.startsWith(prefix)) {
+            continue;
+        }
+        names.append(name);
+        if (indexes) {
+            indexes->append(i);
+        }
+    }
+    return names;
+}
 
-#if QT_VERSION >= 0x040700
-    return QDateTime::currentDateTime().toMSecsSinceEpoch();
-#else
-    struct timeval time;
-    if (gettimeofday(&time, 0) == -1) {
-        throw Error(tr("failed to get time of day: %1").arg(strerror(errno)));
+quint16
+Engine::getPortId(const QString &name)
+{
+    int id = portNames.indexOf(name);
+    if (id == -1) {
+        assert(portNames.count() <= 0xffff);
+        id = portNames.count();
+        portDroppedCounts.append(0);
+        portNames.append(name);
+        portSequences.append(0);
     }
-    return (static_cast<quint64>(time.tv_sec) * 1000) +
-        (static_cast<quint64>(time.tv_usec) / 1000);
-#endif
+    return static_cast<quint16>(id);
+}
+
+QString
+Engine::getPortName(quint16 id) const
+{
+    assert(id < portNames.count());
+    return portNames[id];
+}
+
+int
+Engine::getRealTimeCpu() const
+{
+    return realTimeCpu.load();
+}
+
+bool
+Engine::getRealTimeEnabled() const
+{
+    return realTimeEnabled.load();
+}
+
+int
+Engine::getRealTimePolicy() const
+{
+    return realTimePolicy.load();
+}
 
+int
+Engine::getRealTimePriority() const
+{
+    return realTimePriority.load();
+}
+
+RealTimeStatus
+Engine::getRealTimeStatus(int index) const
+{
+    const Capture *capture = getCapture(index);
+    assert(capture);
+    RealTimeStatus status;
+    status.affinity =
+        static_cast<RealTimeResult>(capture->affinityResult.loadAcquire());
+    status.memoryLock =
+        static_cast<RealTimeResult>(capture->memoryLockResult.load());
+    status.scheduling =
+        static_cast<RealTimeResult>(capture->schedulingResult.loadAcquire());
+    return status;
+}
+
+QSharedPointer<SpillFile>
+Engine::getSpillFile(quint16 port) const
+{
+    for (int i = captures.count() - 1; i >= 0; i--) {
+        const Capture *capture = captures[i];
+        if (capture->port == port) {
+            return capture->spillFile;
+        }
+    }
+    return QSharedPointer<SpillFile>();
+}
+
+quint32
+Engine::getSpillThreshold() const
+{
+    return spillThreshold.load();
+}
+
+const LatencyStatistics &
+Engine::getWakeupLatency(int index) const
+{
+    const Capture *capture = getCapture(index);
+    assert(capture);
+    return capture->latency;
 }
 
 void
-Engine::handleMidiInput(double /*timeStamp*/,
+Engine::handleMidiInput(Capture &capture, double timeStamp,
                         const std::vector<unsigned char> &message)
 {
-    switch (message[0]) {
-    case 0xf0:
-        if (ignoreSystemExclusiveEvents) {
-            qWarning() << "RtMidi did not filter system exclusive event";
-            return;
+    if (capture.realTimeGeneration != realTimeGeneration.loadAcquire()) {
+        applyRealTimeMode(capture);
+    }
+
+    // RtMidi's delta times are relative to the previous message, even if that
+    // message ends up being ignored.
+    quint64 receiveTime = clock.getReceiveTime(timeStamp,
+                                               capture.lastReceiveTime);
+    capture.lastReceiveTime = receiveTime;
+
+    // Wakeup latency is measured against the driver's own timeline, which is
+    // the sum of RtMidi's delta times since the first message.  Unlike
+    // receive times, it's never reset to the time a message is handled.  The
+    // delay of the first message isn't known, so delays are measured from
+    // the shortest delay seen so far.
+    quint64 now = clock.getTime();
+    if (! capture.driverOrigin) {
+        capture.driverOrigin = now;
+        capture.driverTime = 0.0;
+        capture.minimumDelay = 0;
+    } else if (timeStamp >= 0.0) {
+        capture.driverTime += timeStamp;
+        qint64 delay = static_cast<qint64>(now - capture.driverOrigin) -
+            static_cast<qint64>(std::floor((capture.driverTime * 1000000.0) +
+                                           0.5));
+        if (delay < capture.minimumDelay) {
+            capture.minimumDelay = delay;
         }
-        break;
-    case 0xf1:
-    case 0xf8:
-    case 0xf9:
-        if (ignoreTimeEvents) {
-            qWarning() << "RtMidi did not filter time event";
-            return;
+        capture.latency.add(static_cast<quint64>(delay -
+                                                 capture.minimumDelay));
+    }
+
+    // Clock messages are analyzed before they're filtered, so that they can
+    // be analyzed without filling the message list.
+    const quint8 *data = message.data();
+    quint32 length = static_cast<quint32>(message.size());
+    if ((length == 1) && clockAnalysisEnabled.load()) {
+        switch (data[0]) {
+        case 0xf8:
+            capture.clockAnalyzer.addTick(receiveTime);
+            break;
+        case 0xfa:
+            capture.clockAnalyzer.restart();
         }
-        break;
-    case 0xfe:
-        if (ignoreActiveSensingEvents) {
-            qWarning() << "RtMidi did not filter active sensing event";
+    }
+
+    // The filter is read without a lock.  The callback moves on to a new
+    // filter the next time it runs, and then says so, and a replaced filter
+    // is only freed once every running callback has moved past it.  The
+    // generation is read with an ordered read-modify-write, so that either
+    // this read sees a newer generation, or `freeRetiredFilters` sees that
+    // the callback is running.
+    int filterGeneration = messageFilterGeneration.fetchAndAddOrdered(0);
+    if (capture.filterGeneration != filterGeneration) {
+        capture.filter = messageFilter.loadAcquire();
+        capture.filterGeneration = filterGeneration;
+        capture.filterGenerationSeen.storeRelease(filterGeneration);
+    }
+    if (! capture.filter->accepts(data, length)) {
+        return;
+    }
+
+    // This runs on the MIDI driver's thread, so the message is only queued
+    // here.  What happens when the queue is full depends on the queue's
+    // overflow policy.  Every message gets a sequence number, whether or not
+    // it's dropped, so that the GUI can tell where messages are missing.
+    MidiEvent event;
+    event.flags = 0;
+    event.length = length;
+    event.port = capture.port;
+    event.sequence = capture.sequence++;
+    event.timeStamp = receiveTime;
+    if (length > spillThreshold.load()) {
+
+        // Large messages are written to the spill file, and only a preview of
+        // the message is queued.
+        quint64 offset;
+        if (capture.spillFile->write(data, length, offset)) {
+            quint8 *preview = capture.spillPreview;
+            std::memcpy(preview, data, MidiEvent::PREVIEW_SIZE - 1);
+            preview[MidiEvent::PREVIEW_SIZE - 1] = data[length - 1];
+            std::memcpy(preview + MidiEvent::PREVIEW_SIZE, &offset,
+                        sizeof(offset));
+            event.flags = MidiEvent::FLAG_SPILLED;
+            capture.queue.push(event, preview);
             return;
         }
+        qWarning() << "failed to write message to spill file";
+    }
+    capture.queue.push(event, data);
+}
+
+void
+Engine::handlePortsChange()
+{
+    try {
+        updatePortLists();
+    } catch (RtError &e) {
+        qWarning() << e.what();
+    }
+}
+
+bool
+Engine::isInputPortOpen(int index) const
+{
+    assert((index >= 0) && (index < inputPortNames.count()));
+    return getCapture(index) != 0;
+}
+
+QStringList
+Engine::numberPorts(const QStringList &driverNames, const QStringList &names,
+                    const QStringList &openNames)
+{
+    // Ports that share a driver name are numbered, so that each port has a
+    // name of its own, and same-named devices aren't mixed up.  RtMidi
+    // doesn't say which of a set of same-named ports went away, so a port
+    // keeps its number for as long as the driver lists as many ports of
+    // that name.  When there are fewer, closed ports are dropped before open
+    // ones, and new ports take the lowest free numbers.
+    QHash<QString, QList<int> > numbers;
+    for (int i = 0; i < names.count(); i++) {
+        const QString &name = names[i];
+        if (portNameParts.contains(name)) {
+            const PortName &parts = portNameParts[name];
+            numbers[parts.driverName].append(parts.number);
+        }
+    }
+    QHash<QString, int> driverCounts;
+    for (int i = 0; i < driverNames.count(); i++) {
+        driverCounts[driverNames[i]]++;
+    }
+    QHash<QString, int>::const_iterator iter;
+    for (iter = driverCounts.constBegin(); iter != driverCounts.constEnd();
+         iter++) {
+        const QString &driverName = iter.key();
+        int count = iter.value();
+        QList<int> &portNumbers = numbers[driverName];
+        std::sort(portNumbers.begin(), portNumbers.end());
+        for (int i = portNumbers.count() - 1;
+             (i >= 0) && (portNumbers.count() > count); i--) {
+            QString name = getNumberedPortName(driverName, portNumbers[i]);
+            if (! openNames.contains(name)) {
+                portNumbers.removeAt(i);
+            }
+        }
+        while (portNumbers.count() > count) {
+            portNumbers.removeLast();
+        }
+        for (int number = 1; portNumbers.count() < count; number++) {
+            if (! portNumbers.contains(number)) {
+                portNumbers.append(number);
+            }
+        }
+        std::sort(portNumbers.begin(), portNumbers.end());
+    }
+
+    // The numbers are handed out in the driver's order.
+    QStringList numberedNames;
+    QHash<QString, int> ranks;
+    for (int i = 0; i < driverNames.count(); i++) {
+        const QString &driverName = driverNames[i];
+        int &rank = ranks[driverName];
+        numberedNames.append(getNumberedPortName(driverName,
+                                                 numbers[driverName][rank]));
+        rank++;
+    }
+    return numberedNames;
+}
+
+void
+Engine::removeInputPort(int index)
+{
+    assert((index >= 0) && (index < inputPortNames.count()));
+    setInputPortOpen(index, false);
+    for (int i = captures.count() - 1; i >= 0; i--) {
+        Capture *capture = captures[i];
+        if (capture->index > index) {
+            capture->index--;
+        }
     }
-    quint64 timeStamp = getCurrentTimestamp();
-    QByteArray msg;
-    int size = static_cast<int>(message.size());
-    for (int i = 0; i < size; i++) {
-        msg.append(message[i]);
+    inputPortNames.removeAt(index);
+    emit inputPortRemoved(index);
+}
+
+void
+Engine::removeOutputPort(int index)
+{
+    assert((index >= 0) && (index < outputPortNames.count()));
+    if (outputPort == index) {
+        setOutputPort(-1);
+    } else if (outputPort > index) {
+        outputPort--;
     }
-    emit messageReceived(timeStamp, msg);
+    outputPortNames.removeAt(index);
+    emit outputPortRemoved(index);
 }
 
 void
 Engine::removePorts()
 {
-    setInputPort(-1);
+    for (int i = captures.count() - 1; i >= 0; i--) {
+        setInputPortOpen(captures[i]->index, false);
+    }
     setOutputPort(-1);
     for (int i = inputPortNames.count() - 1; i >= 0; i--) {
         inputPortNames.removeAt(i);
@@ -234,20 +738,96 @@ Engine::removePorts()
     }
 }
 
-quint64
-Engine::sendMessage(const QByteArray &message)
+void
+Engine::reopenInputPorts()
 {
-    assert(outputPort != -1);
-    std::vector<unsigned char> msg;
-    for (int i = 0; i < message.count(); i++) {
-        msg.push_back(static_cast<unsigned char>(message[i]));
+    QList<int> indexes;
+    for (int i = 0; i < captures.count(); i++) {
+        indexes.append(captures[i]->index);
+    }
+    for (int i = indexes.count() - 1; i >= 0; i--) {
+        setInputPortOpen(indexes[i], false);
+    }
+    for (int i = 0; i < indexes.count(); i++) {
+        setInputPortOpen(indexes[i], true);
+    }
+}
+
+void
+Engine::resetClockAnalysis()
+{
+    for (int i = captures.count() - 1; i >= 0; i--) {
+        captures[i]->clockAnalyzer.requestReset();
     }
+}
+
+void
+Engine::sendMessages(const MessageBatch &batch, QVector<quint64> &timeStamps)
+{
+    assert(outputPort != -1);
+    int count = batch.getCount();
+    timeStamps.resize(0);
+    timeStamps.reserve(count);
     try {
-        output->sendMessage(&msg);
+        for (int i = 0; i < count; i++) {
+            const quint8 *message = batch.getMessage(i);
+            sendBuffer.assign(message, message + batch.getMessageLength(i));
+            output->sendMessage(&sendBuffer);
+            timeStamps.append(clock.getTime());
+        }
     } catch (RtError &e) {
         throw Error(e.what());
     }
-    return getCurrentTimestamp();
+}
+
+void
+Engine::setCaptureByteLimit(int limit)
+{
+    assert(limit > 0);
+    if (captureByteLimit != limit) {
+        captureByteLimit = limit;
+
+        // Queues are allocated up front, so open ports are reopened to get
+        // queues of the new size.
+        reopenInputPorts();
+        emit captureByteLimitChanged(limit);
+    }
+}
+
+void
+Engine::setCaptureEventLimit(int limit)
+{
+    assert(limit > 0);
+    if (captureEventLimit != limit) {
+        captureEventLimit = limit;
+        reopenInputPorts();
+        emit captureEventLimitChanged(limit);
+    }
+}
+
+void
+Engine::setClockAnalysisEnabled(bool enabled)
+{
+    if (static_cast<bool>(clockAnalysisEnabled.load()) != enabled) {
+        clockAnalysisEnabled.store(enabled);
+        for (int i = captures.count() - 1; i >= 0; i--) {
+            Capture *capture = captures[i];
+            capture->clockAnalyzer.requestReset();
+            updateEventFilter(*capture);
+        }
+        emit clockAnalysisEnabledChanged(enabled);
+    }
+}
+
+void
+Engine::setDeliveryRate(int rate)
+{
+    assert((rate > 0) && (rate <= 1000));
+    if (deliveryRate != rate) {
+        deliveryRate = rate;
+        messageTimer.setInterval(1000 / rate);
+        emit deliveryRateChanged(rate);
+    }
 }
 
 void
@@ -258,6 +838,7 @@ Engine::setDriver(int index)
 
         // Close the currently open MIDI driver.
         if (driver != -1) {
+            portWatcher.stop();
             removePorts();
             delete input;
             delete output;
@@ -269,29 +850,18 @@ Engine::setDriver(int index)
         if (index != -1) {
             RtMidi::Api api = driverAPIs[index];
             try {
-                input = new RtMidiIn(api, "midisnoop");
+                input = new RtMidiIn(api, clientName.toStdString());
                 QScopedPointer<RtMidiIn> inputPtr(input);
-                output = new RtMidiOut(api, "midisnoop");
+                output = new RtMidiOut(api, clientName.toStdString());
                 QScopedPointer<RtMidiOut> outputPtr(output);
-                input->setCallback(handleMidiInput, this);
 
                 // Add ports.
                 try {
-                    unsigned int count = input->getPortCount();
-                    QString name;
-                    for (unsigned int i = 0; i < count; i++) {
-                        name = QString::fromStdString(input->getPortName(i));
-                        inputPortNames.append(name);
-                        emit inputPortAdded(i, name);
-                    }
-                    count = output->getPortCount();
-                    for (unsigned int i = 0; i < count; i++) {
-                        name = QString::fromStdString(output->getPortName(i));
-                        outputPortNames.append(name);
-                        emit outputPortAdded(i, name);
-                    }
+                    virtualPortsAdded = false;
+                    updatePortLists();
 
                     // Add a virtual port to drivers that support virtual ports.
+                    QString name;
                     switch (api) {
                     case RtMidi::LINUX_ALSA:
                     case RtMidi::MACOSX_CORE:
@@ -317,6 +887,7 @@ Engine::setDriver(int index)
                 throw Error(e.what());
             }
             driver = index;
+            portWatcher.start(api);
             emit driverChanged(index);
         }
     }
@@ -325,66 +896,144 @@ Engine::setDriver(int index)
 void
 Engine::setIgnoreActiveSensingEvents(bool ignore)
 {
-    if (ignoreActiveSensingEvents != ignore) {
-        ignoreActiveSensingEvents = ignore;
-        updateEventFilter();
-        emit ignoreActiveSensingEventsChanged(ignore);
-    }
+    setStatusesIgnored(activeSensingStatuses, 1, ignore);
 }
 
 void
 Engine::setIgnoreSystemExclusiveEvents(bool ignore)
 {
-    if (ignoreSystemExclusiveEvents != ignore) {
-        ignoreSystemExclusiveEvents = ignore;
-        updateEventFilter();
-        emit ignoreSystemExclusiveEventsChanged(ignore);
-    }
+    setStatusesIgnored(systemExclusiveStatuses, 1, ignore);
 }
 
 void
 Engine::setIgnoreTimeEvents(bool ignore)
 {
-    if (ignoreTimeEvents != ignore) {
-        ignoreTimeEvents = ignore;
-        updateEventFilter();
-        emit ignoreTimeEventsChanged(ignore);
-    }
+    setStatusesIgnored(timeStatuses, 3, ignore);
 }
 
 void
-Engine::setInputPort(int index)
+Engine::setInputPortOpen(int index, bool open)
 {
-    assert((index >= -1) && (index < inputPortNames.count()));
-    if (inputPort != index) {
+    assert((index >= 0) && (index < inputPortNames.count()));
+    Capture *capture = getCapture(index);
+    if (open == (capture != 0)) {
+        return;
+    }
 
-        // Close the currently open input port.
-        if (inputPort != -1) {
-            try {
-                input->closePort();
-            } catch (RtError &e) {
-                qWarning() << e.what();
-            }
-            inputPort = -1;
-            emit inputPortChanged(-1);
+    // Close the port.  The queue is closed first, so that a callback waiting
+    // for room in the queue doesn't keep the port from closing.
+    if (! open) {
+        capture->queue.close();
+        try {
+            capture->input->closePort();
+        } catch (RtError &e) {
+            qWarning() << e.what();
         }
 
-        // Open the new input port.
-        if (index != -1) {
-            try {
-                if (virtualPortsAdded &&
-                    (index == (inputPortNames.count() - 1))) {
-                    input->openVirtualPort("MIDI Input");
-                } else {
-                    input->openPort(index, "MIDI Input");
-                }
-            } catch (RtError &e) {
-                throw Error(e.what());
+        // The port's callback won't be called again, so deliver whatever is
+        // left in the port's queue before the queue goes away.
+        deliverMessages();
+        quint16 port = capture->port;
+        portDroppedCounts[port] += capture->queue.getDroppedCount();
+        portSequences[port] = capture->sequence;
+        captures.removeOne(capture);
+        delete capture->input;
+        delete capture;
+        freeRetiredFilters();
+        if (captures.isEmpty()) {
+            messageTimer.stop();
+        }
+        emit inputPortOpenChanged(index, false);
+        return;
+    }
+
+    // Open the port.
+    QScopedPointer<Capture>
+        capturePtr(new Capture(static_cast<quint32>(captureEventLimit),
+                               static_cast<quint32>(captureByteLimit)));
+    capture = capturePtr.data();
+    capture->engine = this;
+    capture->filter = 0;
+    capture->filterGeneration = -1;
+    capture->filterGenerationSeen.store(messageFilterGeneration.load());
+    capture->inCallback.store(0);
+    capture->index = index;
+    capture->driverOrigin = 0;
+    capture->lastReceiveTime = 0;
+    capture->port = getPortId(inputPortNames[index]);
+    capture->queue.setOverflowPolicy(overflowPolicy);
+    capture->affinityResult.store(REALTIMERESULT_NONE);
+    capture->realTimeGeneration = -1;
+    capture->schedulingResult.store(REALTIMERESULT_NONE);
+    capture->sequence = portSequences[capture->port];
+    updateMemoryLock(*capture);
+    capture->spillFile = QSharedPointer<SpillFile>(new SpillFile());
+    capture->spillFile->open();
+    try {
+        capture->input =
+            new RtMidiIn(driverAPIs[driver], clientName.toStdString());
+        QScopedPointer<RtMidiIn> inputPtr(capture->input);
+        capture->input->setCallback(handleMidiInput, capture);
+        if (virtualPortsAdded && (index == (inputPortNames.count() - 1))) {
+            capture->input->openVirtualPort("MIDI Input");
+        } else {
+
+            // Ports are matched by name (see `getPortNames`), as port lists
+            // are updated incrementally and so needn't be in the driver's
+            // order.
+            int port = findPort(*(capture->input), inputPortNames[index],
+                                inputPortNames);
+            if (port == -1) {
+                throw Error(tr("input port '%1' is no longer available").
+                            arg(inputPortNames[index]));
             }
-            inputPort = index;
-            updateEventFilter();
-            emit inputPortChanged(index);
+            capture->input->openPort(port, "MIDI Input");
         }
+        updateEventFilter(*capture);
+        inputPtr.take();
+    } catch (RtError &e) {
+        throw Error(e.what());
+    }
+    captures.append(capturePtr.take());
+    if (! messageTimer.isActive()) {
+        messageTimer.start();
+    }
+    emit inputPortOpenChanged(index, true);
+}
+
+void
+Engine::setMessageFilter(const MessageFilter &filter)
+{
+    MessageFilter *oldFilter = messageFilter.load();
+    if (*oldFilter == filter) {
+        return;
+    }
+    bool ignoreActiveSensingEvents = getIgnoreActiveSensingEvents();
+    bool ignoreSystemExclusiveEvents = getIgnoreSystemExclusiveEvents();
+    bool ignoreTimeEvents = getIgnoreTimeEvents();
+
+    // Callbacks may still be using the old filter, so it's retired instead
+    // of being deleted, and freed once every callback has moved on.  The
+    // new filter is published before the generation that announces it.
+    messageFilter.storeRelease(new MessageFilter(filter));
+    RetiredFilter retired;
+    retired.filter = oldFilter;
+    retired.generation = messageFilterGeneration.fetchAndAddOrdered(1) + 1;
+    retiredFilters.append(retired);
+    freeRetiredFilters();
+
+    for (int i = captures.count() - 1; i >= 0; i--) {
+        updateEventFilter(*(captures[i]));
+    }
+    emit messageFilterChanged(filter);
+    if (ignoreActiveSensingEvents != getIgnoreActiveSensingEvents()) {
+        emit ignoreActiveSensingEventsChanged(! ignoreActiveSensingEvents);
+    }
+    if (ignoreSystemExclusiveEvents != getIgnoreSystemExclusiveEvents()) {
+        emit ignoreSystemExclusiveEventsChanged(! ignoreSystemExclusiveEvents);
+    }
+    if (ignoreTimeEvents != getIgnoreTimeEvents()) {
+        emit ignoreTimeEventsChanged(! ignoreTimeEvents);
     }
 }
 
@@ -412,7 +1061,14 @@ Engine::setOutputPort(int index)
                     (index == (outputPortNames.count() - 1))) {
                     output->openVirtualPort("MIDI Output");
                 } else {
-                    output->openPort(index, "MIDI Output");
+                    int port = findPort(*output, outputPortNames[index],
+                                        outputPortNames);
+                    if (port == -1) {
+                        throw Error(tr("output port '%1' is no longer "
+                                       "available").
+                                    arg(outputPortNames[index]));
+                    }
+                    output->openPort(port, "MIDI Output");
                 }
             } catch (RtError &e) {
                 throw Error(e.what());
@@ -424,10 +1080,164 @@ Engine::setOutputPort(int index)
 }
 
 void
-Engine::updateEventFilter()
+Engine::setOverflowPolicy(int policy)
+{
+    assert((policy >= MessageQueue::OVERFLOWPOLICY_DROP_NEWEST) &&
+           (policy <= MessageQueue::OVERFLOWPOLICY_BLOCK));
+    if (overflowPolicy != policy) {
+        overflowPolicy = static_cast<MessageQueue::OverflowPolicy>(policy);
+        for (int i = captures.count() - 1; i >= 0; i--) {
+            captures[i]->queue.setOverflowPolicy(overflowPolicy);
+        }
+        emit overflowPolicyChanged(policy);
+    }
+}
+
+void
+Engine::setRealTimeCpu(int cpu)
+{
+    assert(cpu >= -1);
+    if (realTimeCpu.load() != cpu) {
+        realTimeCpu.store(cpu);
+        realTimeGeneration.fetchAndAddRelease(1);
+        emit realTimeCpuChanged(cpu);
+    }
+}
+
+void
+Engine::setRealTimeEnabled(bool enabled)
+{
+    if (static_cast<bool>(realTimeEnabled.load()) != enabled) {
+        realTimeEnabled.store(enabled);
+        realTimeGeneration.fetchAndAddRelease(1);
+        for (int i = captures.count() - 1; i >= 0; i--) {
+            updateMemoryLock(*(captures[i]));
+        }
+        emit realTimeEnabledChanged(enabled);
+    }
+}
+
+void
+Engine::setRealTimePolicy(int policy)
 {
-    if (inputPort != -1) {
-        input->ignoreTypes(ignoreSystemExclusiveEvents, ignoreTimeEvents,
-                           ignoreActiveSensingEvents);
+    assert((policy == REALTIMEPOLICY_FIFO) ||
+           (policy == REALTIMEPOLICY_ROUND_ROBIN));
+    if (realTimePolicy.load() != policy) {
+        realTimePolicy.store(policy);
+        realTimeGeneration.fetchAndAddRelease(1);
+        emit realTimePolicyChanged(policy);
+    }
+}
+
+void
+Engine::setRealTimePriority(int priority)
+{
+    assert((priority >= 1) && (priority <= 99));
+    if (realTimePriority.load() != priority) {
+        realTimePriority.store(priority);
+        realTimeGeneration.fetchAndAddRelease(1);
+        emit realTimePriorityChanged(priority);
+    }
+}
+
+void
+Engine::setSpillThreshold(quint32 threshold)
+{
+    assert(threshold >= MidiEvent::PREVIEW_SIZE);
+    spillThreshold.store(threshold);
+}
+
+void
+Engine::setStatusesIgnored(const quint8 *statuses, int count, bool ignore)
+{
+    MessageFilter filter(*(messageFilter.load()));
+    for (int i = 0; i < count; i++) {
+        filter.setStatusAccepted(statuses[i], ! ignore);
+    }
+    setMessageFilter(filter);
+}
+
+void
+Engine::updateEventFilter(Capture &capture)
+{
+    // Let RtMidi discard whole classes of messages that the filter rejects,
+    // so that they never reach the callback.  Clock messages have to reach
+    // the callback while they're being analyzed.
+    capture.input->ignoreTypes(getIgnoreSystemExclusiveEvents(),
+                               getIgnoreTimeEvents() &&
+                               (! clockAnalysisEnabled.load()),
+                               getIgnoreActiveSensingEvents());
+}
+
+void
+Engine::updateMemoryLock(Capture &capture)
+{
+    if (realTimeEnabled.load()) {
+        capture.memoryLockResult.store(capture.queue.setMemoryLocked(true));
+    } else {
+        capture.queue.setMemoryLocked(false);
+        capture.memoryLockResult.store(REALTIMERESULT_NONE);
+    }
+}
+
+void
+Engine::updatePortLists()
+{
+    // Only the ports that were actually added or removed are reported, so
+    // open ports, and the messages captured from them, are left alone.  New
+    // ports are inserted before the virtual ports, which are always last.
+    int count = inputPortNames.count() - (virtualPortsAdded ? 1 : 0);
+    QStringList openNames;
+    for (int i = captures.count() - 1; i >= 0; i--) {
+        openNames.append(inputPortNames[captures[i]->index]);
+    }
+    QStringList names = numberPorts(getPortNames(*input),
+                                    inputPortNames.mid(0, count), openNames);
+    for (int i = count - 1; i >= 0; i--) {
+        if (! names.contains(inputPortNames[i])) {
+            removeInputPort(i);
+            count--;
+        }
+    }
+    for (int i = 0; i < names.count(); i++) {
+        const QString &name = names[i];
+        if (inputPortNames.mid(0, count).contains(name)) {
+            continue;
+        }
+        for (int j = captures.count() - 1; j >= 0; j--) {
+            Capture *capture = captures[j];
+            if (capture->index >= count) {
+                capture->index++;
+            }
+        }
+        inputPortNames.insert(count, name);
+        emit inputPortAdded(count, name);
+        count++;
+    }
+
+    count = outputPortNames.count() - (virtualPortsAdded ? 1 : 0);
+    openNames.clear();
+    if ((outputPort != -1) && (outputPort < count)) {
+        openNames.append(outputPortNames[outputPort]);
+    }
+    names = numberPorts(getPortNames(*output), outputPortNames.mid(0, count),
+                        openNames);
+    for (int i = count - 1; i >= 0; i--) {
+        if (! names.contains(outputPortNames[i])) {
+            removeOutputPort(i);
+            count--;
+        }
+    }
+    for (int i = 0; i < names.count(); i++) {
+        const QString &name = names[i];
+        if (outputPortNames.mid(0, count).contains(name)) {
+            continue;
+        }
+        if (outputPort >= count) {
+            outputPort++;
+        }
+        outputPortNames.insert(count, name);
+        emit outputPortAdded(count, name);
+        count++;
     }
 }
@@ -20,12 +20,28 @@
 #ifndef __ENGINE_H__
 #define __ENGINE_H__
 
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QAtomicPointer>
 #include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QStringList>
+#include <QtCore/QTimer>
 #include <QtCore/QVector>
 
 #include <RtMidi.h>
 
+#include "captureclock.h"
+#include "clockanalyzer.h"
+#include "eventblock.h"
+#include "latencystatistics.h"
+#include "messagebatch.h"
+#include "messagefilter.h"
+#include "messagequeue.h"
+#include "portwatcher.h"
+#include "realtime.h"
+#include "spillfile.h"
+
 class Engine: public QObject {
 
     Q_OBJECT
@@ -37,6 +53,21 @@ public:
 
     ~Engine();
 
+    int
+    getCaptureByteLimit() const;
+
+    int
+    getCaptureEventLimit() const;
+
+    bool
+    getClockAnalysisEnabled() const;
+
+    const ClockAnalyzer &
+    getClockAnalyzer(int index) const;
+
+    int
+    getDeliveryRate() const;
+
     int
     getDriver() const;
 
@@ -46,6 +77,9 @@ public:
     QString
     getDriverName(int index) const;
 
+    quint32
+    getDroppedCount(quint16 port) const;
+
     bool
     getIgnoreActiveSensingEvents() const;
 
@@ -55,15 +89,15 @@ public:
     bool
     getIgnoreTimeEvents() const;
 
-    int
-    getInputPort() const;
-
     int
     getInputPortCount() const;
 
     QString
     getInputPortName(int index) const;
 
+    const MessageFilter &
+    getMessageFilter() const;
+
     int
     getOutputPort() const;
 
@@ -73,10 +107,64 @@ public:
     QString
     getOutputPortName(int index) const;
 
+    int
+    getOverflowPolicy() const;
+
+    QString
+    getPortName(quint16 id) const;
+
+    int
+    getRealTimeCpu() const;
+
+    bool
+    getRealTimeEnabled() const;
+
+    int
+    getRealTimePolicy() const;
+
+    int
+    getRealTimePriority() const;
+
+    RealTimeStatus
+    getRealTimeStatus(int index) const;
+
+    // Returns the spill file of the open input port with the given id.  The
+    // file is shared, so that the payloads of messages received from the
+    // port can still be read after the port is closed.
+    QSharedPointer<SpillFile>
+    getSpillFile(quint16 port) const;
+
+    quint32
+    getSpillThreshold() const;
+
+    const LatencyStatistics &
+    getWakeupLatency(int index) const;
+
+    bool
+    isInputPortOpen(int index) const;
+
 public slots:
 
-    quint64
-    sendMessage(const QByteArray &message);
+    // Restarts the clock analysis of every open input port.
+    void
+    resetClockAnalysis();
+
+    // Sends each message in the batch, and stores the time at which each
+    // message was sent in `timeStamps`.
+    void
+    sendMessages(const MessageBatch &batch, QVector<quint64> &timeStamps);
+
+    void
+    setCaptureByteLimit(int limit);
+
+    void
+    setCaptureEventLimit(int limit);
+
+    void
+    setClockAnalysisEnabled(bool enabled);
+
+    void
+    setDeliveryRate(int rate);
 
     void
     setDriver(int index);
@@ -91,13 +179,46 @@ public slots:
     setIgnoreTimeEvents(bool ignore);
 
     void
-    setInputPort(int index);
+    setInputPortOpen(int index, bool open);
+
+    void
+    setMessageFilter(const MessageFilter &filter);
 
     void
     setOutputPort(int index);
 
+    void
+    setOverflowPolicy(int policy);
+
+    void
+    setRealTimeCpu(int cpu);
+
+    void
+    setRealTimeEnabled(bool enabled);
+
+    void
+    setRealTimePolicy(int policy);
+
+    void
+    setRealTimePriority(int priority);
+
+    void
+    setSpillThreshold(quint32 threshold);
+
 signals:
 
+    void
+    captureByteLimitChanged(int limit);
+
+    void
+    captureEventLimitChanged(int limit);
+
+    void
+    clockAnalysisEnabledChanged(bool enabled);
+
+    void
+    deliveryRateChanged(int rate);
+
     void
     driverChanged(int index);
 
@@ -114,13 +235,16 @@ signals:
     inputPortAdded(int index, const QString &name);
 
     void
-    inputPortChanged(int index);
+    inputPortOpenChanged(int index, bool open);
 
     void
     inputPortRemoved(int index);
 
     void
-    messageReceived(quint64 timeStamp, const QByteArray &message);
+    messageFilterChanged(const MessageFilter &filter);
+
+    void
+    messagesReceived(const EventBlock &block);
 
     void
     outputPortAdded(int index, const QString &name);
@@ -131,37 +255,186 @@ signals:
     void
     outputPortRemoved(int index);
 
+    void
+    overflowPolicyChanged(int policy);
+
+    void
+    realTimeCpuChanged(int cpu);
+
+    void
+    realTimeEnabledChanged(bool enabled);
+
+    void
+    realTimePolicyChanged(int policy);
+
+    void
+    realTimePriorityChanged(int priority);
+
+private slots:
+
+    void
+    deliverMessages();
+
+    void
+    handlePortsChange();
+
 private:
 
+    // An open input port.  Each open input port has an RtMidi input of its
+    // own, and so its own callback thread, queue and spill file.  The
+    // callback thread records the outcome of the real-time mode steps it
+    // applies to itself, the generation of the message filter it uses, and
+    // whether it's running.
+    struct Capture {
+
+        Capture(quint32 eventLimit, quint32 byteLimit):
+            queue(eventLimit, byteLimit)
+        {
+            // Empty
+        }
+
+        QAtomicInteger<int> affinityResult;
+        ClockAnalyzer clockAnalyzer;
+        quint64 driverOrigin;
+        double driverTime;
+        Engine *engine;
+        const MessageFilter *filter;
+        int filterGeneration;
+        QAtomicInteger<int> filterGenerationSeen;
+        QAtomicInteger<int> inCallback;
+        int index;
+        RtMidiIn *input;
+        quint64 lastReceiveTime;
+        LatencyStatistics latency;
+        QAtomicInteger<int> memoryLockResult;
+        qint64 minimumDelay;
+        quint16 port;
+        MessageQueue queue;
+        int realTimeGeneration;
+        QAtomicInteger<int> schedulingResult;
+        quint32 sequence;
+        QSharedPointer<SpillFile> spillFile;
+        quint8 spillPreview[MidiEvent::SPILLED_DATA_SIZE];
+
+    };
+
+    // A port name, split into the name the driver gives the port, and the
+    // port's number among the driver's ports of that name.
+    struct PortName {
+        QString driverName;
+        int number;
+    };
+
+    // A message filter that has been replaced, but may still be in use by
+    // callbacks that haven't moved on to a newer `generation` yet.
+    struct RetiredFilter {
+        MessageFilter *filter;
+        int generation;
+    };
+
     static void
     handleMidiInput(double timeStamp, std::vector<unsigned char> *message,
-                    void *engine);
+                    void *capture);
+
+    void
+    applyRealTimeMode(Capture &capture);
+
+    bool
+    areStatusesIgnored(const quint8 *statuses, int count) const;
+
+    // Returns the index, in the driver's port list, of the port with the
+    // given name in `names`, or -1 if there's no such port.
+    int
+    findPort(RtMidi &midi, const QString &name,
+             const QStringList &names) const;
+
+    void
+    freeRetiredFilters();
+
+    Capture *
+    getCapture(int index) const;
+
+    // Returns the name of a port, given the port's name in the driver and
+    // its number among the driver's ports of that name.
+    QString
+    getNumberedPortName(const QString &driverName, int number);
 
-    quint64
-    getCurrentTimestamp() const;
+    quint16
+    getPortId(const QString &name);
+
+    // Returns the names of the driver's ports, as the driver gives them.  If
+    // `indexes` is given, the index of each port in the driver's list is
+    // appended to it.
+    QStringList
+    getPortNames(RtMidi &midi, QList<unsigned int> *indexes=0) const;
 
     void
-    handleMidiInput(double timeStamp,
+    handleMidiInput(Capture &capture, double timeStamp,
                     const std::vector<unsigned char> &message);
 
+    // Returns names for ports with the given driver names, keeping the
+    // numbers of the ports in `names` where the ports still exist.
+    QStringList
+    numberPorts(const QStringList &driverNames, const QStringList &names,
+                const QStringList &openNames);
+
+    void
+    removeInputPort(int index);
+
+    void
+    removeOutputPort(int index);
+
     void
     removePorts();
 
     void
-    updateEventFilter();
+    reopenInputPorts();
 
+    void
+    setStatusesIgnored(const quint8 *statuses, int count, bool ignore);
+
+    void
+    updateEventFilter(Capture &capture);
+
+    void
+    updateMemoryLock(Capture &capture);
+
+    void
+    updatePortLists();
+
+    int captureByteLimit;
+    int captureEventLimit;
+    QList<Capture *> captures;
+    QString clientName;
+    QAtomicInteger<int> clockAnalysisEnabled;
+    CaptureClock clock;
+    int deliveryRate;
     int driver;
     QList<RtMidi::Api> driverAPIs;
     QStringList driverNames;
-    bool ignoreActiveSensingEvents;
-    bool ignoreSystemExclusiveEvents;
-    bool ignoreTimeEvents;
     RtMidiIn *input;
-    int inputPort;
     QStringList inputPortNames;
+    EventBlock messageBlock;
+    QAtomicPointer<MessageFilter> messageFilter;
+    QAtomicInteger<int> messageFilterGeneration;
+    QTimer messageTimer;
     RtMidiOut *output;
     int outputPort;
     QStringList outputPortNames;
+    MessageQueue::OverflowPolicy overflowPolicy;
+    QVector<quint32> portDroppedCounts;
+    QHash<QString, PortName> portNameParts;
+    QStringList portNames;
+    QVector<quint32> portSequences;
+    PortWatcher portWatcher;
+    QAtomicInteger<int> realTimeCpu;
+    QAtomicInteger<int> realTimeEnabled;
+    QAtomicInteger<int> realTimeGeneration;
+    QAtomicInteger<int> realTimePolicy;
+    QAtomicInteger<int> realTimePriority;
+    QList<RetiredFilter> retiredFilters;
+    std::vector<unsigned char> sendBuffer;
+    QAtomicInteger<quint32> spillThreshold;
     bool virtualPortsAdded;
 
 };
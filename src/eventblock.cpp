@@ -0,0 +1,80 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+
+#include "eventblock.h"
+
+EventBlock::EventBlock()
+{
+    events.reserve(256);
+}
+
+EventBlock::~EventBlock()
+{
+    // Empty
+}
+
+void
+EventBlock::append(const MidiEvent &event, const quint8 *data)
+{
+    events.append(event);
+    if (! event.isInline()) {
+        events.last().dataOffset = arena.append(data, event.getDataSize());
+    }
+}
+
+void
+EventBlock::clear()
+{
+    arena.clear();
+    events.resize(0);
+}
+
+int
+EventBlock::getCount() const
+{
+    return events.count();
+}
+
+const quint8 *
+EventBlock::getData(const MidiEvent &event) const
+{
+    return event.isInline() ? event.data : arena.getData(event.dataOffset);
+}
+
+const MidiEvent &
+EventBlock::getEvent(int index) const
+{
+    assert((index >= 0) && (index < events.count()));
+    return events[index];
+}
+
+bool
+EventBlock::isEmpty() const
+{
+    return events.isEmpty();
+}
+
+void
+EventBlock::removeLast()
+{
+    assert(! events.isEmpty());
+    events.removeLast();
+}
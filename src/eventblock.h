@@ -0,0 +1,70 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __EVENTBLOCK_H__
+#define __EVENTBLOCK_H__
+
+#include <QtCore/QVector>
+
+#include "midievent.h"
+#include "sysexarena.h"
+
+// A block of received MIDI events that is delivered to the GUI in one go.
+// Clearing a block keeps its storage, so a block that's reused from one
+// delivery to the next stops allocating once it reaches its working size.
+
+class EventBlock {
+
+public:
+
+    EventBlock();
+
+    ~EventBlock();
+
+    void
+    append(const MidiEvent &event, const quint8 *data);
+
+    void
+    clear();
+
+    int
+    getCount() const;
+
+    const quint8 *
+    getData(const MidiEvent &event) const;
+
+    const MidiEvent &
+    getEvent(int index) const;
+
+    bool
+    isEmpty() const;
+
+    // Removes the last event.  Arena space used by the event isn't reclaimed
+    // until the block is cleared.
+    void
+    removeLast();
+
+private:
+
+    SysExArena arena;
+    QVector<MidiEvent> events;
+
+};
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "filterview.h"
+#include "util.h"
+
+FilterView::FilterView(QObject *parent):
+    DesignerView(":/midisnoop/filterview.ui", parent)
+{
+    QWidget *rootWidget = getRootWidget();
+
+    closeButton = getChild<QPushButton>(rootWidget, "closeButton");
+    connect(closeButton, SIGNAL(clicked()), SIGNAL(closeRequest()));
+
+    filterEnabled = getChild<QCheckBox>(rootWidget, "filterEnabled");
+    connect(filterEnabled, SIGNAL(clicked(bool)),
+            SIGNAL(filterEnabledChangeRequest(bool)));
+
+    messageFilterEditor = new MessageFilterEditor(rootWidget, this);
+    connect(messageFilterEditor,
+            SIGNAL(filterChangeRequest(const MessageFilter &)),
+            SIGNAL(filterChangeRequest(const MessageFilter &)));
+}
+
+FilterView::~FilterView()
+{
+    // Empty
+}
+
+void
+FilterView::setFilter(const MessageFilter &filter)
+{
+    messageFilterEditor->setFilter(filter);
+}
+
+void
+FilterView::setFilterEnabled(bool enabled)
+{
+    filterEnabled->setChecked(enabled);
+}
@@ -0,0 +1,65 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __FILTERVIEW_H__
+#define __FILTERVIEW_H__
+
+#include <QtWidgets/QCheckBox>
+#include <QtWidgets/QPushButton>
+
+#include "designerview.h"
+#include "messagefilter.h"
+#include "messagefiltereditor.h"
+
+class FilterView: public DesignerView {
+
+    Q_OBJECT
+
+public:
+
+    explicit
+    FilterView(QObject *parent=0);
+
+    ~FilterView();
+
+public slots:
+
+    void
+    setFilter(const MessageFilter &filter);
+
+    void
+    setFilterEnabled(bool enabled);
+
+signals:
+
+    void
+    filterChangeRequest(const MessageFilter &filter);
+
+    void
+    filterEnabledChangeRequest(bool enabled);
+
+private:
+
+    QPushButton *closeButton;
+    QCheckBox *filterEnabled;
+    MessageFilterEditor *messageFilterEditor;
+
+};
+
+#endif
@@ -0,0 +1,120 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "error.h"
+#include "hexparser.h"
+
+// Static functions
+
+static inline int
+getHexDigitValue(ushort c)
+{
+    if ((c >= '0') && (c <= '9')) {
+        return c - '0';
+    }
+    if ((c >= 'a') && (c <= 'f')) {
+        return c - 'a' + 10;
+    }
+    if ((c >= 'A') && (c <= 'F')) {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static inline bool
+isSpace(ushort c)
+{
+    return (c == ' ') || ((c >= '\t') && (c <= '\r')) ||
+        ((c >= 0x80) && QChar(c).isSpace());
+}
+
+// Class definition
+
+MessageBatch
+HexParser::parse(const QString &text)
+{
+    MessageBatch batch;
+
+    // Every byte but the last takes at least two characters.
+    int length = text.length();
+    batch.data.resize((length / 2) + 1);
+    char *out = batch.data.data();
+    int count = 0;
+    int messageStart = 0;
+
+    const QChar *characters = text.constData();
+    int i = 0;
+    for (;;) {
+
+        // Skip to the next token, ending the current message at the end of
+        // each line.
+        ushort c = 0;
+        for (; i < length; i++) {
+            c = characters[i].unicode();
+            if (! isSpace(c)) {
+                break;
+            }
+            if ((c == '\n') && (count > messageStart)) {
+                batch.ends.append(count);
+                messageStart = count;
+            }
+        }
+        if (i == length) {
+            break;
+        }
+
+        // Parse the token.
+        int start = i;
+        if ((c == '0') && ((i + 2) < length) &&
+            ((characters[i + 1].unicode() | 0x20) == 'x')) {
+            i += 2;
+        }
+        int digits = 0;
+        int value = 0;
+        for (; i < length; i++) {
+            int digit = getHexDigitValue(characters[i].unicode());
+            if (digit == -1) {
+                break;
+            }
+            value = (value << 4) | digit;
+            digits++;
+        }
+        if ((! digits) || (digits > 2) ||
+            ((i < length) && (! isSpace(characters[i].unicode())))) {
+            while ((i < length) && (! isSpace(characters[i].unicode()))) {
+                i++;
+            }
+            throw Error(tr("'%1' is not a valid hexadecimal MIDI byte").
+                        arg(text.mid(start, i - start)));
+        }
+
+        // Status bytes start new messages, except for the byte that ends a
+        // system exclusive message.
+        if ((value >= 0x80) && (value != 0xf7) && (count > messageStart)) {
+            batch.ends.append(count);
+            messageStart = count;
+        }
+        out[count++] = static_cast<char>(value);
+    }
+    if (count > messageStart) {
+        batch.ends.append(count);
+    }
+    batch.data.resize(count);
+    return batch;
+}
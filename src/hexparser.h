@@ -0,0 +1,49 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __HEXPARSER_H__
+#define __HEXPARSER_H__
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QString>
+
+#include "messagebatch.h"
+
+// Parses MIDI messages written as hexadecimal bytes.  Bytes are separated by
+// any whitespace, and may have a '0x' prefix.  Each line holds one or more
+// messages; within a line, every status byte other than 'f7' (the end of a
+// system exclusive message) starts a new message.
+//
+// The text is parsed in a single pass, straight into the batch's buffer, so
+// that pasting megabytes of system exclusive data doesn't stall.
+
+class HexParser {
+
+    Q_DECLARE_TR_FUNCTIONS(HexParser)
+
+public:
+
+    // Throws an `Error` if the text contains something other than
+    // hexadecimal bytes.
+    static MessageBatch
+    parse(const QString &text);
+
+};
+
+#endif
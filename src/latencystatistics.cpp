@@ -0,0 +1,120 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+
+#include <QtCore/QThread>
+
+#include "latencystatistics.h"
+
+// Snapshot definition
+
+quint64
+LatencySnapshot::getMean() const
+{
+    return count ? total / count : 0;
+}
+
+quint64
+LatencySnapshot::getPercentile(int percent) const
+{
+    assert((percent > 0) && (percent <= 100));
+    quint64 n = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        n += buckets[i];
+    }
+    quint64 target = ((n * percent) + 99) / 100;
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i];
+        if (seen && (seen >= target)) {
+            return i ? (Q_UINT64_C(1) << i) : 0;
+        }
+    }
+    return 0;
+}
+
+// Class definition
+
+LatencyStatistics::LatencyStatistics()
+{
+    for (int i = 0; i < LatencySnapshot::BUCKET_COUNT; i++) {
+        buckets[i].store(0);
+    }
+    count.store(0);
+    maximum.store(0);
+    sequence.store(0);
+    total.store(0);
+}
+
+LatencyStatistics::~LatencyStatistics()
+{
+    // Empty
+}
+
+void
+LatencyStatistics::add(quint64 latency)
+{
+    // Bucket `i` holds latencies below 2^i microseconds.
+    int bucket = 0;
+    while ((bucket < (LatencySnapshot::BUCKET_COUNT - 1)) &&
+           ((latency >> bucket) != 0)) {
+        bucket++;
+    }
+
+    // A read-modify-write, so that none of the writes in the update can be
+    // seen before the sequence number is odd.
+    sequence.fetchAndAddOrdered(1);
+    buckets[bucket].storeRelease(buckets[bucket].load() + 1);
+    if (latency > maximum.load()) {
+        maximum.storeRelease(latency);
+    }
+    total.storeRelease(total.load() + latency);
+    count.storeRelease(count.load() + 1);
+    sequence.storeRelease(sequence.load() + 1);
+}
+
+LatencySnapshot
+LatencyStatistics::getSnapshot() const
+{
+    LatencySnapshot snapshot;
+    for (;;) {
+        quint32 start = sequence.loadAcquire();
+        if (! (start & 1)) {
+
+            // Every field is read with acquire semantics, so if any of them
+            // was written by a later update, then the second read of the
+            // sequence number sees that update's odd number, at least.
+            for (int i = 0; i < LatencySnapshot::BUCKET_COUNT; i++) {
+                snapshot.buckets[i] = buckets[i].loadAcquire();
+            }
+            snapshot.count = count.loadAcquire();
+            snapshot.maximum = maximum.loadAcquire();
+            snapshot.total = total.loadAcquire();
+            if (sequence.load() == start) {
+                break;
+            }
+        } else {
+
+            // Updates are short, unless the writer was preempted.
+            QThread::yieldCurrentThread();
+        }
+    }
+    return snapshot;
+}
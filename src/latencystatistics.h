@@ -0,0 +1,87 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __LATENCYSTATISTICS_H__
+#define __LATENCYSTATISTICS_H__
+
+#include <QtCore/QAtomicInteger>
+
+// A snapshot of a `LatencyStatistics` object's histogram.  Latencies are in
+// microseconds.  Bucket `i` counts the latencies below 2^i microseconds that
+// the buckets before it don't count, so percentiles are upper bounds.
+
+struct LatencySnapshot {
+
+    static const int BUCKET_COUNT = 32;
+
+    quint64
+    getMean() const;
+
+    quint64
+    getPercentile(int percent) const;
+
+    quint32 buckets[BUCKET_COUNT];
+    quint32 count;
+    quint64 maximum;
+    quint64 total;
+
+};
+
+// Statistics about the latency between a MIDI message's arrival and the
+// invocation of the callback that receives it.  Arrival times come from the
+// driver's timestamps, whose offset from our clock isn't known, so latencies
+// are measured from the shortest delay seen.  Latencies are recorded by the
+// callback thread and read by the GUI thread.  There's only ever one writer,
+// so recording doesn't need read-modify-write operations, apart from the one
+// that starts an update.
+//
+// As in `ClockAnalyzer`, the writer makes the sequence number odd while it
+// records a latency, and even again when it's done, so that a reader can tell
+// when the snapshot it took was torn by an update, and take it again.
+
+class LatencyStatistics {
+
+public:
+
+    LatencyStatistics();
+
+    ~LatencyStatistics();
+
+    void
+    add(quint64 latency);
+
+    LatencySnapshot
+    getSnapshot() const;
+
+private:
+
+    LatencyStatistics(const LatencyStatistics &);
+
+    LatencyStatistics &
+    operator=(const LatencyStatistics &);
+
+    QAtomicInteger<quint32> buckets[LatencySnapshot::BUCKET_COUNT];
+    QAtomicInteger<quint32> count;
+    QAtomicInteger<quint64> maximum;
+    QAtomicInteger<quint32> sequence;
+    QAtomicInteger<quint64> total;
+
+};
+
+#endif
@@ -19,14 +19,31 @@
 
 #include <cassert>
 
-#include <QtWidgets/QApplication>
+#include <QtWidgets/QFileDialog>
+#include <QtWidgets/QHeaderView>
+#include <QtWidgets/QScrollBar>
+#include <QtWidgets/QStatusBar>
+#include <QtWidgets/QStyle>
 
 #include "mainview.h"
+#include "nametables.h"
 #include "util.h"
 
+// Static functions
+
+QString
+MainView::getCaptureFileFilter()
+{
+    return tr("midisnoop Captures (*.midisnoop);;All Files (*)");
+}
+
+// Class definition
+
 MainView::MainView(QObject *parent):
     DesignerView(":/midisnoop/mainview.ui", parent)
 {
+    filterModel = 0;
+
     QWidget *widget = getRootWidget();
 
     aboutAction = getChild<QAction>(widget, "aboutAction");
@@ -41,26 +58,61 @@ MainView::MainView(QObject *parent):
     connect(clearAction, SIGNAL(triggered()),
             SIGNAL(clearMessagesRequest()));
 
+    clockAction = getChild<QAction>(widget, "clockAction");
+    connect(clockAction, SIGNAL(triggered()),
+            SIGNAL(clockAnalysisRequest()));
+
     configureAction = getChild<QAction>(widget, "configureAction");
     connect(configureAction, SIGNAL(triggered()),
             SIGNAL(configureRequest()));
 
+    expandAction = getChild<QAction>(widget, "expandAction");
+    connect(expandAction, SIGNAL(triggered()),
+            SLOT(handleExpandActionTrigger()));
+
+    filterAction = getChild<QAction>(widget, "filterAction");
+    connect(filterAction, SIGNAL(triggered()),
+            SIGNAL(displayFilterRequest()));
+
+    openAction = getChild<QAction>(widget, "openAction");
+    connect(openAction, SIGNAL(triggered()),
+            SLOT(handleOpenActionTrigger()));
+
     quitAction = getChild<QAction>(widget, "quitAction");
     connect(quitAction, SIGNAL(triggered()),
             SIGNAL(closeRequest()));
 
-    tableModel.setColumnCount(MESSAGETABLECOLUMN_TOTAL);
-    tableModel.setRowCount(0);
-    tableModel.setHeaderData(MESSAGETABLECOLUMN_DATA, Qt::Horizontal,
-                             tr("Data"), Qt::DisplayRole);
-    tableModel.setHeaderData(MESSAGETABLECOLUMN_STATUS, Qt::Horizontal,
-                             tr("Status"), Qt::DisplayRole);
-    tableModel.setHeaderData(MESSAGETABLECOLUMN_TIMESTAMP, Qt::Horizontal,
-                             tr("Timestamp"), Qt::DisplayRole);
+    saveAction = getChild<QAction>(widget, "saveAction");
+    connect(saveAction, SIGNAL(triggered()),
+            SLOT(handleSaveActionTrigger()));
+
+    // Shows how far the display filter has searched the messages.
+    searchProgress = new QProgressBar();
+    searchProgress->setFormat(tr("Filtering %p%"));
+    searchProgress->setVisible(false);
+    getChild<QStatusBar>(widget, "statusbar")->
+        addPermanentWidget(searchProgress);
 
     tableView = getChild<QTableView>(widget, "centralWidget");
     tableView->setItemDelegate(&tableDelegate);
-    tableView->setModel(&tableModel);
+    setTableModel(&tableModel);
+
+    // Rows all have the same height, so inserting them doesn't measure any
+    // text.  Messages that don't fit on one line are expanded on request.
+    QHeaderView *header = tableView->verticalHeader();
+    header->setDefaultSectionSize(tableView->fontMetrics().lineSpacing() +
+                                  (2 * tableView->style()->pixelMetric
+                                   (QStyle::PM_FocusFrameVMargin)) + 2);
+    header->setSectionResizeMode(QHeaderView::Fixed);
+
+    // Old messages are dropped before the list takes more than 512 MiB.
+    tableModel.setByteLimit(512 * 1048576);
+
+    // The view is scrolled to new messages at most once per pass through the
+    // event loop, however many batches of messages arrive in that pass.
+    scrollTimer.setInterval(0);
+    scrollTimer.setSingleShot(true);
+    connect(&scrollTimer, SIGNAL(timeout()), SLOT(handleScrollTimeout()));
 }
 
 MainView::~MainView()
@@ -68,61 +120,228 @@ MainView::~MainView()
     // Empty
 }
 
+void
+MainView::addLoadedPages(MessageTableModel::PageBuilder &pages)
+{
+    if (pages.getRowCount()) {
+        followMessages();
+        tableModel.addPages(pages);
+    }
+}
+
+void
+MainView::addReceivedMessages(const QVector<MainView::Message> &messages)
+{
+    if (! messages.isEmpty()) {
+        followMessages();
+        tableModel.addMessages(messages);
+    }
+}
+
+void
+MainView::addReceivedMessages(const QVector<MainView::MessageRef> &messages)
+{
+    if (! messages.isEmpty()) {
+        followMessages();
+        tableModel.addMessages(messages);
+    }
+}
+
+void
+MainView::addSentMessages(const QString &port, const MessageBatch &batch,
+                          const QVector<quint64> &timeStamps)
+{
+    int count = batch.getCount();
+    assert(timeStamps.count() == count);
+    QVector<Message> messages(count);
+    for (int i = 0; i < count; i++) {
+        Message &sent = messages[i];
+        sent.annotation.kind = Annotation::KIND_NONE;
+        int length = batch.getMessageLength(i);
+        sent.data = batch.data.mid(batch.getMessageStart(i), length);
+        sent.length = static_cast<quint32>(length);
+        sent.port = port;
+        sent.timeStamp = timeStamps[i];
+        sent.totalDropped = 0;
+        sent.type = MessageTableModel::MESSAGETYPE_SENT;
+    }
+    followMessages();
+    tableModel.addMessages(messages);
+}
+
+void
+MainView::changeEvent(QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::LanguageChange:
+    case QEvent::LocaleChange:
+        NameTables::getInstance().invalidate();
+        tableModel.retranslate();
+        break;
+    default:
+        ;
+    }
+}
+
+void
+MainView::clearMessages()
+{
+    // The model is reset instead of having its rows removed one by one.
+    tableModel.clear();
+}
+
+void
+MainView::followMessages()
+{
+    // All of the rows of a batch are inserted at once so that the model only
+    // signals a single insertion, no matter how many messages there are.
+    //
+    // The view only follows new messages when it's already at the bottom, so
+    // that it stays put while older messages are being looked at.
+    QScrollBar *scrollBar = tableView->verticalScrollBar();
+    if ((! scrollTimer.isActive()) &&
+        (scrollBar->value() == scrollBar->maximum())) {
+        scrollTimer.start();
+    }
+}
+
+const MessageFilter &
+MainView::getDisplayFilter() const
+{
+    return displayFilter;
+}
+
+bool
+MainView::getDisplayFilterEnabled() const
+{
+    return filterModel != 0;
+}
+
+const MessageTableModel &
+MainView::getMessageModel() const
+{
+    return tableModel;
+}
+
+quint16
+MainView::getPortId(const QString &port)
+{
+    return tableModel.getPortId(port);
+}
+
+qint64
+MainView::getScrollbackByteLimit() const
+{
+    return tableModel.getByteLimit();
+}
+
 int
-MainView::addMessage(quint64 timeStamp, const QString &statusDescription,
-                     const QString &dataDescription, bool valid)
-{
-    int count = tableModel.rowCount();
-    bool inserted = tableModel.insertRow(count);
-    assert(inserted);
-    Qt::AlignmentFlag alignment = Qt::AlignTop;
-    setModelData(count, MESSAGETABLECOLUMN_DATA, dataDescription);
-    setModelData(count, MESSAGETABLECOLUMN_DATA, alignment,
-                 Qt::TextAlignmentRole);
-    setModelData(count, MESSAGETABLECOLUMN_STATUS, statusDescription);
-    setModelData(count, MESSAGETABLECOLUMN_STATUS, alignment,
-                 Qt::TextAlignmentRole);
-    setModelData(count, MESSAGETABLECOLUMN_TIMESTAMP, timeStamp);
-    setModelData(count, MESSAGETABLECOLUMN_TIMESTAMP, alignment,
-                 Qt::TextAlignmentRole);
-    if (! valid) {
-        setModelData(count, MESSAGETABLECOLUMN_STATUS,
-                     QIcon(":/midisnoop/images/16x16/error.png"),
-                     Qt::DecorationRole);
+MainView::getScrollbackRowLimit() const
+{
+    return tableModel.getRowLimit();
+}
+
+void
+MainView::handleExpandActionTrigger()
+{
+    QModelIndex index = tableView->currentIndex();
+    if (! index.isValid()) {
+        return;
+    }
+    // Expanding a spilled message also shows the whole message, instead of
+    // its preview.
+    int row = index.row();
+    int sourceRow = filterModel ? filterModel->mapToSource(index).row() : row;
+    QHeaderView *header = tableView->verticalHeader();
+    if (header->sectionSize(row) != header->defaultSectionSize()) {
+        tableModel.setMessageExpanded(sourceRow, false);
+        tableView->setRowHeight(row, header->defaultSectionSize());
+    } else {
+        tableModel.setMessageExpanded(sourceRow, true);
+        tableView->resizeRowToContents(row);
     }
-    tableView->resizeRowToContents(count);
+}
+
+void
+MainView::handleOpenActionTrigger()
+{
+    QString path =
+        QFileDialog::getOpenFileName(getRootWidget(), tr("Open Capture"),
+                                     QString(), getCaptureFileFilter());
+    if (! path.isEmpty()) {
+        emit loadCaptureRequest(path);
+    }
+}
+
+void
+MainView::handleRowRemoval(const QModelIndex &/*parent*/, int first,
+                           int last)
+{
+    // Old messages are removed from the top of the list, which would make
+    // the messages being looked at move.  The view is moved up along with
+    // them, unless it's following new messages anyway.
+    if (! scrollTimer.isActive()) {
+        QScrollBar *scrollBar = tableView->verticalScrollBar();
+        scrollBar->setValue(scrollBar->value() -
+                            ((last - first + 1) *
+                             tableView->verticalHeader()->
+                             defaultSectionSize()));
+    }
+}
+
+void
+MainView::handleSaveActionTrigger()
+{
+    QString path =
+        QFileDialog::getSaveFileName(getRootWidget(), tr("Save Capture"),
+                                     QString(), getCaptureFileFilter());
+    if (! path.isEmpty()) {
+        emit saveCaptureRequest(path);
+    }
+}
+
+void
+MainView::handleScrollTimeout()
+{
     tableView->scrollToBottom();
-    return count;
 }
 
 void
-MainView::addReceivedMessage(quint64 timeStamp,
-                             const QString &statusDescription,
-                             const QString &dataDescription, bool valid)
+MainView::handleSearchProgress(int finished, int total)
 {
-    addMessage(timeStamp, statusDescription, dataDescription, valid);
+    searchProgress->setMaximum(qMax(total, 1));
+    searchProgress->setValue(finished);
+    searchProgress->setVisible(finished < total);
 }
 
 void
-MainView::addSentMessage(quint64 timeStamp, const QString &statusDescription,
-                         const QString &dataDescription, bool valid)
+MainView::setDisplayFilter(const MessageFilter &filter)
 {
-    int index = addMessage(timeStamp, statusDescription, dataDescription,
-                           valid);
-    const QBrush &brush = qApp->palette().alternateBase();
-    setModelData(index, MESSAGETABLECOLUMN_DATA, brush, Qt::BackgroundRole);
-    setModelData(index, MESSAGETABLECOLUMN_STATUS, brush, Qt::BackgroundRole);
-    setModelData(index, MESSAGETABLECOLUMN_TIMESTAMP, brush,
-                 Qt::BackgroundRole);
+    displayFilter = filter;
+    if (filterModel) {
+        filterModel->setFilter(filter);
+    }
 }
 
 void
-MainView::clearMessages()
+MainView::setDisplayFilterEnabled(bool enabled)
 {
-    int count = tableModel.rowCount();
-    if (count) {
-        bool removed = tableModel.removeRows(0, tableModel.rowCount());
-        assert(removed);
+    // The filter model is only kept while it's shown, so that messages
+    // aren't checked against a filter nobody's looking at.
+    if (enabled == (filterModel != 0)) {
+        return;
+    }
+    if (enabled) {
+        filterModel = new MessageFilterModel(tableModel, this);
+        connect(filterModel, SIGNAL(searchProgressChanged(int, int)),
+                SLOT(handleSearchProgress(int, int)));
+        setTableModel(filterModel);
+        filterModel->setFilter(displayFilter);
+    } else {
+        setTableModel(&tableModel);
+        delete filterModel;
+        filterModel = 0;
+        searchProgress->setVisible(false);
     }
 }
 
@@ -133,9 +352,28 @@ MainView::setMessageSendEnabled(bool enabled)
 }
 
 void
-MainView::setModelData(int row, int column, const QVariant &value, int role)
+MainView::setTableModel(QAbstractItemModel *model)
+{
+    QAbstractItemModel *oldModel = tableView->model();
+    if (oldModel) {
+        disconnect(oldModel,
+                   SIGNAL(rowsRemoved(const QModelIndex &, int, int)), this,
+                   SLOT(handleRowRemoval(const QModelIndex &, int, int)));
+    }
+    tableView->setModel(model);
+    connect(model, SIGNAL(rowsRemoved(const QModelIndex &, int, int)),
+            SLOT(handleRowRemoval(const QModelIndex &, int, int)));
+    tableView->scrollToBottom();
+}
+
+void
+MainView::setScrollbackByteLimit(qint64 limit)
+{
+    tableModel.setByteLimit(limit);
+}
+
+void
+MainView::setScrollbackRowLimit(int limit)
 {
-    bool result = tableModel.setData(tableModel.index(row, column), value,
-                                     role);
-    assert(result);
+    tableModel.setRowLimit(limit);
 }
@@ -20,13 +20,19 @@
 #ifndef __MAINVIEW_H__
 #define __MAINVIEW_H__
 
-#include <QtGui/QStandardItemModel>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
 #include <QtWidgets/QAction>
 #include <QtWidgets/QMainWindow>
+#include <QtWidgets/QProgressBar>
 #include <QtWidgets/QTableView>
 
 #include "designerview.h"
+#include "messagebatch.h"
+#include "messagefilter.h"
+#include "messagefiltermodel.h"
 #include "messagetabledelegate.h"
+#include "messagetablemodel.h"
 
 class MainView: public DesignerView {
 
@@ -34,27 +40,66 @@ class MainView: public DesignerView {
 
 public:
 
+    typedef MessageTableModel::Message Message;
+    typedef MessageTableModel::MessageRef MessageRef;
+
     explicit
     MainView(QObject *parent=0);
 
     ~MainView();
 
+    // Adds the rows of the pages that `pages` can hand over.
+    void
+    addLoadedPages(MessageTableModel::PageBuilder &pages);
+
+    const MessageFilter &
+    getDisplayFilter() const;
+
+    bool
+    getDisplayFilterEnabled() const;
+
+    const MessageTableModel &
+    getMessageModel() const;
+
+    quint16
+    getPortId(const QString &port);
+
+    qint64
+    getScrollbackByteLimit() const;
+
+    int
+    getScrollbackRowLimit() const;
+
 public slots:
 
     void
-    addReceivedMessage(quint64 timeStamp, const QString &statusDescription,
-                       const QString &dataDescription, bool valid);
+    addReceivedMessages(const QVector<MainView::Message> &messages);
 
     void
-    addSentMessage(quint64 timeStamp, const QString &statusDescription,
-                   const QString &dataDescription, bool valid);
+    addReceivedMessages(const QVector<MainView::MessageRef> &messages);
+
+    void
+    addSentMessages(const QString &port, const MessageBatch &batch,
+                    const QVector<quint64> &timeStamps);
 
     void
     clearMessages();
 
+    void
+    setDisplayFilter(const MessageFilter &filter);
+
+    void
+    setDisplayFilterEnabled(bool enabled);
+
     void
     setMessageSendEnabled(bool enabled);
 
+    void
+    setScrollbackByteLimit(qint64 limit);
+
+    void
+    setScrollbackRowLimit(int limit);
+
 signals:
 
     void
@@ -66,34 +111,73 @@ signals:
     void
     clearMessagesRequest();
 
+    void
+    clockAnalysisRequest();
+
     void
     configureRequest();
 
-private:
+    void
+    displayFilterRequest();
 
-    enum MessageTableColumn {
-        MESSAGETABLECOLUMN_TIMESTAMP = 0,
-        MESSAGETABLECOLUMN_STATUS = 1,
-        MESSAGETABLECOLUMN_DATA = 2,
+    void
+    loadCaptureRequest(const QString &path);
 
-        MESSAGETABLECOLUMN_TOTAL = 3
-    };
+    void
+    saveCaptureRequest(const QString &path);
 
-    int
-    addMessage(quint64 timeStamp, const QString &statusDescription,
-               const QString &dataDescription, bool valid);
+protected:
+
+    void
+    changeEvent(QEvent *event);
+
+private slots:
+
+    void
+    handleExpandActionTrigger();
+
+    void
+    handleOpenActionTrigger();
+
+    void
+    handleRowRemoval(const QModelIndex &parent, int first, int last);
+
+    void
+    handleSaveActionTrigger();
+
+    void
+    handleSearchProgress(int finished, int total);
+
+    void
+    handleScrollTimeout();
+
+private:
+
+    static QString
+    getCaptureFileFilter();
+
+    void
+    followMessages();
 
     void
-    setModelData(int row, int column, const QVariant &value,
-                 int role=Qt::DisplayRole);
+    setTableModel(QAbstractItemModel *model);
 
     QAction *aboutAction;
     QAction *addAction;
     QAction *clearAction;
+    QAction *clockAction;
     QAction *configureAction;
-    MessageTableDelegate tableDelegate;
+    MessageFilter displayFilter;
+    QAction *expandAction;
+    QAction *filterAction;
+    MessageFilterModel *filterModel;
+    QAction *openAction;
     QAction *quitAction;
-    QStandardItemModel tableModel;
+    QAction *saveAction;
+    QProgressBar *searchProgress;
+    QTimer scrollTimer;
+    MessageTableDelegate tableDelegate;
+    MessageTableModel tableModel;
     QTableView *tableView;
 
 };
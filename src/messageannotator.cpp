@@ -0,0 +1,226 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cstring>
+
+#include "messageannotator.h"
+
+// Static data
+
+static const quint8 unknownValue = 0xff;
+
+// Static functions
+
+static Annotation
+getAnnotation(quint8 kind, quint16 number=0, quint32 value=0)
+{
+    Annotation annotation;
+    annotation.kind = kind;
+    annotation.number = number;
+    annotation.value = value;
+    return annotation;
+}
+
+// Class definition
+
+MessageAnnotator::MessageAnnotator()
+{
+    // Empty
+}
+
+MessageAnnotator::~MessageAnnotator()
+{
+    // Empty
+}
+
+Annotation
+MessageAnnotator::annotate(quint16 port, const DecodedMessage &decoded)
+{
+    switch (decoded.kind) {
+    case DecodedMessage::KIND_CONTROL_CHANGE:
+    case DecodedMessage::KIND_MTC_QUARTER_FRAME:
+        break;
+    default:
+        return getAnnotation(Annotation::KIND_NONE);
+    }
+    int count = ports.count();
+    if (port >= count) {
+        ports.resize(port + 1);
+        for (int i = count; i <= port; i++) {
+            resetPortState(ports[i]);
+        }
+    }
+    PortState &state = ports[port];
+    if (decoded.kind == DecodedMessage::KIND_MTC_QUARTER_FRAME) {
+        return annotateQuarterFrame(state, static_cast<quint8>(decoded.number),
+                                    static_cast<quint8>(decoded.value));
+    }
+    return annotateControlChange(state.channels[decoded.channel],
+                                 static_cast<quint8>(decoded.number),
+                                 static_cast<quint8>(decoded.value));
+}
+
+Annotation
+MessageAnnotator::annotateControlChange(ChannelState &state,
+                                        quint8 controller, quint8 value)
+{
+    bool parameterSelected = state.parameterType != PARAMETERTYPE_NONE;
+    switch (controller) {
+
+    // Parameter selection.  Selecting RPN 127/127 (the null parameter)
+    // deselects the current parameter.
+    case 0x62:
+    case 0x63:
+        if (controller == 0x62) {
+            state.nrpnLSB = value;
+        } else {
+            state.nrpnMSB = value;
+        }
+        state.parameterType = PARAMETERTYPE_NRPN;
+        state.parameterValue = -1;
+        return getAnnotation(Annotation::KIND_NONE);
+    case 0x64:
+    case 0x65:
+        if (controller == 0x64) {
+            state.rpnLSB = value;
+        } else {
+            state.rpnMSB = value;
+        }
+        state.parameterType = ((state.rpnLSB == 0x7f) &&
+                               (state.rpnMSB == 0x7f)) ?
+            PARAMETERTYPE_NONE : PARAMETERTYPE_RPN;
+        state.parameterValue = -1;
+        return getAnnotation(Annotation::KIND_NONE);
+
+    // Data entry, increment and decrement change the selected parameter.
+    // Without a selected parameter, data entry is an ordinary 14-bit
+    // controller.
+    case 0x60:
+    case 0x61:
+        if ((! parameterSelected) || (state.parameterValue == -1)) {
+            return getAnnotation(Annotation::KIND_NONE);
+        }
+        if (controller == 0x60) {
+            if (state.parameterValue < 0x3fff) {
+                state.parameterValue++;
+            }
+        } else if (state.parameterValue > 0) {
+            state.parameterValue--;
+        }
+        break;
+    case 0x06:
+        if (parameterSelected) {
+            state.parameterValue = static_cast<qint16>(value << 7);
+            break;
+        }
+        // Fallthrough
+    case 0x26:
+        if (parameterSelected) {
+            if (state.parameterValue == -1) {
+                return getAnnotation(Annotation::KIND_NONE);
+            }
+            state.parameterValue =
+                static_cast<qint16>((state.parameterValue & 0x3f80) | value);
+            break;
+        }
+        // Fallthrough
+    default:
+        if (controller < 0x20) {
+            state.controllerMSBs[controller] = value;
+        } else if ((controller < 0x40) &&
+                   (state.controllerMSBs[controller - 0x20] != unknownValue)) {
+            quint8 msb = state.controllerMSBs[controller - 0x20];
+            return getAnnotation(Annotation::KIND_CONTROL_CHANGE_14_BIT,
+                                 controller - 0x20, (msb << 7) | value);
+        }
+        return getAnnotation(Annotation::KIND_NONE);
+    }
+
+    // A parameter's value changed.
+    quint8 lsb;
+    quint8 msb;
+    quint8 kind;
+    if (state.parameterType == PARAMETERTYPE_NRPN) {
+        kind = Annotation::KIND_NRPN;
+        lsb = state.nrpnLSB;
+        msb = state.nrpnMSB;
+    } else {
+        kind = Annotation::KIND_RPN;
+        lsb = state.rpnLSB;
+        msb = state.rpnMSB;
+    }
+    if ((lsb == unknownValue) || (msb == unknownValue)) {
+        return getAnnotation(Annotation::KIND_NONE);
+    }
+    return getAnnotation(kind, (msb << 7) | lsb,
+                         static_cast<quint32>(state.parameterValue));
+}
+
+Annotation
+MessageAnnotator::annotateQuarterFrame(PortState &state, quint8 piece,
+                                       quint8 value)
+{
+    if (piece == 0) {
+        state.nextQuarterFrame = 0;
+    } else if (piece != state.nextQuarterFrame) {
+        state.nextQuarterFrame = -1;
+        return getAnnotation(Annotation::KIND_NONE);
+    }
+    state.quarterFrames[piece] = value;
+    if (piece != 7) {
+        state.nextQuarterFrame++;
+        return getAnnotation(Annotation::KIND_NONE);
+    }
+    state.nextQuarterFrame = -1;
+    const quint8 *frames = state.quarterFrames;
+    quint32 hours = frames[6] | ((frames[7] & 0x1) << 4);
+    quint32 minutes = frames[4] | ((frames[5] & 0x3) << 4);
+    quint32 seconds = frames[2] | ((frames[3] & 0x3) << 4);
+    quint32 frameCount = frames[0] | ((frames[1] & 0x1) << 4);
+    return getAnnotation(Annotation::KIND_TIMECODE, (frames[7] >> 1) & 0x3,
+                         (hours << 24) | (minutes << 16) | (seconds << 8) |
+                         frameCount);
+}
+
+void
+MessageAnnotator::reset()
+{
+    int count = ports.count();
+    for (int i = 0; i < count; i++) {
+        resetPortState(ports[i]);
+    }
+}
+
+void
+MessageAnnotator::resetPortState(PortState &state)
+{
+    for (int i = 0; i < 16; i++) {
+        ChannelState &channel = state.channels[i];
+        std::memset(channel.controllerMSBs, unknownValue,
+                    sizeof(channel.controllerMSBs));
+        channel.nrpnLSB = unknownValue;
+        channel.nrpnMSB = unknownValue;
+        channel.parameterType = PARAMETERTYPE_NONE;
+        channel.parameterValue = -1;
+        channel.rpnLSB = unknownValue;
+        channel.rpnMSB = unknownValue;
+    }
+    state.nextQuarterFrame = -1;
+    std::memset(state.quarterFrames, 0, sizeof(state.quarterFrames));
+}
@@ -0,0 +1,118 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __MESSAGEANNOTATOR_H__
+#define __MESSAGEANNOTATOR_H__
+
+#include <QtCore/QVector>
+
+#include "messagedecoder.h"
+
+// The meaning of a message in the context of the messages received on the
+// same port before it:
+//
+//   - 14-bit control changes: `number` is the MSB controller number (0 - 31),
+//     and `value` is the combined value of the MSB and LSB controllers
+//   - RPN and NRPN changes: `number` is the parameter number, and `value` is
+//     the parameter's value
+//   - Timecodes: `number` is the SMPTE type (0 - 3), and `value` holds the
+//     hours, minutes, seconds and frames, from the most significant byte to
+//     the least significant byte
+
+struct Annotation {
+
+    enum Kind {
+        KIND_NONE = 0,
+        KIND_CONTROL_CHANGE_14_BIT = 1,
+        KIND_NRPN = 2,
+        KIND_RPN = 3,
+        KIND_TIMECODE = 4
+    };
+
+    quint8 kind;
+    quint16 number;
+    quint32 value;
+
+};
+
+// Follows the state of each channel of each port, so that a message can be
+// annotated with what it means along with the messages before it.  14-bit
+// controller pairs are combined, RPN and NRPN transactions are assembled, and
+// the full timecode is rebuilt from each run of eight MTC quarter frames.
+//
+// The state is kept in fixed-size arrays, so annotating a message doesn't
+// allocate memory (ports are only added when they're first seen).
+
+class MessageAnnotator {
+
+public:
+
+    MessageAnnotator();
+
+    ~MessageAnnotator();
+
+    Annotation
+    annotate(quint16 port, const DecodedMessage &decoded);
+
+    void
+    reset();
+
+private:
+
+    enum ParameterType {
+        PARAMETERTYPE_NONE = 0,
+        PARAMETERTYPE_NRPN = 1,
+        PARAMETERTYPE_RPN = 2
+    };
+
+    // 0xff marks controller values that haven't been received, and -1 marks
+    // a parameter value that isn't known.
+    struct ChannelState {
+        quint8 controllerMSBs[32];
+        quint8 nrpnLSB;
+        quint8 nrpnMSB;
+        qint16 parameterValue;
+        quint8 parameterType;
+        quint8 rpnLSB;
+        quint8 rpnMSB;
+    };
+
+    // `nextQuarterFrame` is -1 when the next quarter frame doesn't continue
+    // a run that started with piece 0.
+    struct PortState {
+        ChannelState channels[16];
+        qint8 nextQuarterFrame;
+        quint8 quarterFrames[8];
+    };
+
+    Annotation
+    annotateControlChange(ChannelState &state, quint8 controller,
+                          quint8 value);
+
+    Annotation
+    annotateQuarterFrame(PortState &state, quint8 piece, quint8 value);
+
+    static void
+    resetPortState(PortState &state);
+
+    QVector<PortState> ports;
+
+};
+
+#endif
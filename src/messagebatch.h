@@ -0,0 +1,61 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __MESSAGEBATCH_H__
+#define __MESSAGEBATCH_H__
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+
+// MIDI messages stored back to back in a single buffer.  `ends` holds the
+// offset just past the end of each message.
+
+struct MessageBatch {
+
+    int
+    getCount() const
+    {
+        return ends.count();
+    }
+
+    const quint8 *
+    getMessage(int index) const
+    {
+        return reinterpret_cast<const quint8 *>(data.constData()) +
+            getMessageStart(index);
+    }
+
+    int
+    getMessageLength(int index) const
+    {
+        return ends[index] - getMessageStart(index);
+    }
+
+    int
+    getMessageStart(int index) const
+    {
+        return index ? ends[index - 1] : 0;
+    }
+
+    QByteArray data;
+    QVector<int> ends;
+
+};
+
+#endif
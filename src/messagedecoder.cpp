@@ -0,0 +1,165 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "bytes.h"
+#include "messagedecoder.h"
+
+// Static data
+
+// How the data bytes of a message are laid out.
+enum Layout {
+    LAYOUT_NONE,
+    LAYOUT_NUMBER_VALUE,
+    LAYOUT_QUARTER_FRAME,
+    LAYOUT_SIGNED_FOURTEEN_BIT,
+    LAYOUT_UNSIGNED_FOURTEEN_BIT,
+    LAYOUT_VALUE,
+    LAYOUT_VARIABLE
+};
+
+// Describes the messages that start with a status byte.  A length of -1
+// marks an undefined status byte, and a length of 0 marks a variable-length
+// message.
+struct StatusDescriptor {
+    qint8 length;
+    quint8 kind;
+    quint8 layout;
+};
+
+// Channel messages, indexed by the high nibble of the status byte, minus 8.
+const StatusDescriptor channelDescriptors[7] = {
+    { 3, DecodedMessage::KIND_NOTE_OFF, LAYOUT_NUMBER_VALUE },
+    { 3, DecodedMessage::KIND_NOTE_ON, LAYOUT_NUMBER_VALUE },
+    { 3, DecodedMessage::KIND_POLYPHONIC_PRESSURE, LAYOUT_NUMBER_VALUE },
+    { 3, DecodedMessage::KIND_CONTROL_CHANGE, LAYOUT_NUMBER_VALUE },
+    { 2, DecodedMessage::KIND_PROGRAM_CHANGE, LAYOUT_VALUE },
+    { 2, DecodedMessage::KIND_CHANNEL_PRESSURE, LAYOUT_VALUE },
+    { 3, DecodedMessage::KIND_PITCH_BEND, LAYOUT_SIGNED_FOURTEEN_BIT }
+};
+
+// System messages, indexed by the low nibble of the status byte.
+const StatusDescriptor systemDescriptors[16] = {
+    { 0, DecodedMessage::KIND_SYSTEM_EXCLUSIVE, LAYOUT_VARIABLE },
+    { 2, DecodedMessage::KIND_MTC_QUARTER_FRAME, LAYOUT_QUARTER_FRAME },
+    { 3, DecodedMessage::KIND_SONG_POSITION_POINTER,
+      LAYOUT_UNSIGNED_FOURTEEN_BIT },
+    { 2, DecodedMessage::KIND_SONG_SELECT, LAYOUT_VALUE },
+    { -1, DecodedMessage::KIND_UNDEFINED_STATUS, LAYOUT_NONE },
+    { -1, DecodedMessage::KIND_UNDEFINED_STATUS, LAYOUT_NONE },
+    { 1, DecodedMessage::KIND_TUNE_REQUEST, LAYOUT_NONE },
+    { -1, DecodedMessage::KIND_UNDEFINED_STATUS, LAYOUT_NONE },
+    { 1, DecodedMessage::KIND_CLOCK, LAYOUT_NONE },
+    { 1, DecodedMessage::KIND_TICK, LAYOUT_NONE },
+    { 1, DecodedMessage::KIND_START, LAYOUT_NONE },
+    { 1, DecodedMessage::KIND_CONTINUE, LAYOUT_NONE },
+    { 1, DecodedMessage::KIND_STOP, LAYOUT_NONE },
+    { -1, DecodedMessage::KIND_UNDEFINED_STATUS, LAYOUT_NONE },
+    { 1, DecodedMessage::KIND_ACTIVE_SENSING, LAYOUT_NONE },
+    { 1, DecodedMessage::KIND_RESET, LAYOUT_NONE }
+};
+
+// Functions
+
+DecodedMessage
+decodeMessage(const quint8 *message, quint32 length)
+{
+    DecodedMessage decoded;
+    decoded.channel = 0;
+    decoded.number = 0;
+    decoded.value = 0;
+
+    // Make sure we have an actual message.
+    if (! length) {
+        decoded.dataLength = 0;
+        decoded.kind = DecodedMessage::KIND_EMPTY;
+        decoded.status = 0;
+        return decoded;
+    }
+
+    // Validate status byte.
+    quint8 status = message[0];
+    decoded.dataLength = length - 1;
+    decoded.status = status;
+    if (status < 0x80) {
+        decoded.kind = DecodedMessage::KIND_INVALID_STATUS;
+        return decoded;
+    }
+    const StatusDescriptor &descriptor = (status < 0xf0) ?
+        channelDescriptors[(status >> 4) - 8] :
+        systemDescriptors[status & 0xf];
+
+    // Validate length.
+    quint32 lastDataIndex;
+    switch (descriptor.length) {
+    case -1:
+        decoded.kind = DecodedMessage::KIND_UNDEFINED_STATUS;
+        return decoded;
+    case 0:
+        if (length == 1) {
+            decoded.kind = DecodedMessage::KIND_SYSTEM_EXCLUSIVE_NO_DATA;
+            return decoded;
+        }
+        if (message[length - 1] != 0xf7) {
+            decoded.kind = DecodedMessage::KIND_SYSTEM_EXCLUSIVE_NO_END;
+            return decoded;
+        }
+        lastDataIndex = length - 2;
+        break;
+    default:
+        if (length != static_cast<quint32>(descriptor.length)) {
+            decoded.kind = DecodedMessage::KIND_INCORRECT_LENGTH;
+            return decoded;
+        }
+        lastDataIndex = length - 1;
+    }
+
+    // Validate data bytes.
+    if (containsStatusByte(message + 1, lastDataIndex)) {
+        decoded.kind = DecodedMessage::KIND_INVALID_DATA;
+        return decoded;
+    }
+
+    // Extract fields.
+    decoded.dataLength = lastDataIndex;
+    decoded.kind = descriptor.kind;
+    if (status < 0xf0) {
+        decoded.channel = status & 0xf;
+    }
+    switch (descriptor.layout) {
+    case LAYOUT_NUMBER_VALUE:
+        decoded.number = message[1];
+        decoded.value = message[2];
+        break;
+    case LAYOUT_QUARTER_FRAME:
+        decoded.number = message[1] >> 4;
+        decoded.value = message[1] & 0xf;
+        break;
+    case LAYOUT_SIGNED_FOURTEEN_BIT:
+        decoded.value = ((static_cast<qint32>(message[2]) << 7) |
+                         static_cast<qint32>(message[1])) - 0x2000;
+        break;
+    case LAYOUT_UNSIGNED_FOURTEEN_BIT:
+        decoded.value = (static_cast<qint32>(message[2]) << 7) |
+            static_cast<qint32>(message[1]);
+        break;
+    case LAYOUT_VALUE:
+        decoded.value = message[1];
+    }
+    return decoded;
+}
@@ -0,0 +1,97 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __MESSAGEDECODER_H__
+#define __MESSAGEDECODER_H__
+
+#include <QtCore/QtGlobal>
+
+// The result of decoding a MIDI message.  Decoding validates a message and
+// extracts its fields without doing any string work, so it's cheap, reentrant
+// and safe to use from any thread.  `MessageFormatter` turns decoded messages
+// into text.
+//
+// The meaning of `number` and `value` depends on the kind of message:
+//
+//   - Note and polyphonic pressure messages: note number and velocity or
+//     pressure
+//   - Control change messages: controller number and value
+//   - Program change, channel pressure and song select messages: `value` is
+//     the program, pressure or song number
+//   - Pitch bend messages: `value` is the signed bend amount
+//   - Song position pointer messages: `value` is the MIDI beat
+//   - MTC quarter frame messages: `number` is the piece number, `value` is
+//     the piece's nibble
+//
+// For invalid messages and system exclusive messages, `dataLength` is the
+// number of data bytes that follow the status byte (not counting a system
+// exclusive message's end byte).
+
+struct DecodedMessage {
+
+    enum Kind {
+        KIND_EMPTY = 0,
+        KIND_INVALID_STATUS,
+        KIND_UNDEFINED_STATUS,
+        KIND_INCORRECT_LENGTH,
+        KIND_INVALID_DATA,
+        KIND_SYSTEM_EXCLUSIVE_NO_DATA,
+        KIND_SYSTEM_EXCLUSIVE_NO_END,
+
+        // Valid messages
+        KIND_NOTE_OFF,
+        KIND_NOTE_ON,
+        KIND_POLYPHONIC_PRESSURE,
+        KIND_CONTROL_CHANGE,
+        KIND_PROGRAM_CHANGE,
+        KIND_CHANNEL_PRESSURE,
+        KIND_PITCH_BEND,
+        KIND_SYSTEM_EXCLUSIVE,
+        KIND_MTC_QUARTER_FRAME,
+        KIND_SONG_POSITION_POINTER,
+        KIND_SONG_SELECT,
+        KIND_TUNE_REQUEST,
+        KIND_CLOCK,
+        KIND_TICK,
+        KIND_START,
+        KIND_CONTINUE,
+        KIND_STOP,
+        KIND_ACTIVE_SENSING,
+        KIND_RESET
+    };
+
+    bool
+    isValid() const
+    {
+        return kind >= KIND_NOTE_OFF;
+    }
+
+    quint8 kind;
+    quint8 status;
+    quint8 channel;
+    quint8 number;
+    qint32 value;
+    quint32 dataLength;
+
+};
+
+DecodedMessage
+decodeMessage(const quint8 *message, quint32 length);
+
+#endif
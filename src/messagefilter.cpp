@@ -0,0 +1,160 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "messagefilter.h"
+
+// Static functions
+
+void
+MessageFilter::setBit(quint32 *bits, int index, bool value)
+{
+    quint32 bit = 1U << (index & 0x1f);
+    if (value) {
+        bits[index >> 5] |= bit;
+    } else {
+        bits[index >> 5] &= ~bit;
+    }
+}
+
+// Class definition
+
+MessageFilter::MessageFilter()
+{
+    channels = 0xffff;
+    std::memset(controllers, 0xff, sizeof(controllers));
+    std::memset(notes, 0xff, sizeof(notes));
+    std::memset(statuses, 0xff, sizeof(statuses));
+    for (int i = 0; i < 0x100; i++) {
+        updateAction(static_cast<quint8>(i));
+    }
+}
+
+MessageFilter::~MessageFilter()
+{
+    // Empty
+}
+
+bool
+MessageFilter::isChannelAccepted(int channel) const
+{
+    assert((channel >= 0) && (channel < 16));
+    return channels & (1U << channel);
+}
+
+bool
+MessageFilter::isControllerAccepted(quint8 controller) const
+{
+    assert(controller < 0x80);
+    return isSet(controllers, controller);
+}
+
+bool
+MessageFilter::isNoteAccepted(quint8 note) const
+{
+    assert(note < 0x80);
+    return isSet(notes, note);
+}
+
+bool
+MessageFilter::isStatusAccepted(quint8 status) const
+{
+    return isSet(statuses, status);
+}
+
+bool
+MessageFilter::operator==(const MessageFilter &filter) const
+{
+    // The action table is derived from the masks, so it isn't compared.
+    return (channels == filter.channels) &&
+        (! std::memcmp(controllers, filter.controllers,
+                       sizeof(controllers))) &&
+        (! std::memcmp(notes, filter.notes, sizeof(notes))) &&
+        (! std::memcmp(statuses, filter.statuses, sizeof(statuses)));
+}
+
+bool
+MessageFilter::operator!=(const MessageFilter &filter) const
+{
+    return ! (*this == filter);
+}
+
+void
+MessageFilter::setChannelAccepted(int channel, bool accepted)
+{
+    assert((channel >= 0) && (channel < 16));
+    if (accepted) {
+        channels |= 1U << channel;
+    } else {
+        channels &= ~(1U << channel);
+    }
+    for (int status = 0x80 | channel; status < 0xf0; status += 0x10) {
+        updateAction(static_cast<quint8>(status));
+    }
+}
+
+void
+MessageFilter::setControllerAccepted(quint8 controller, bool accepted)
+{
+    assert(controller < 0x80);
+    setBit(controllers, controller, accepted);
+}
+
+void
+MessageFilter::setNoteAccepted(quint8 note, bool accepted)
+{
+    assert(note < 0x80);
+    setBit(notes, note, accepted);
+}
+
+void
+MessageFilter::setStatusAccepted(quint8 status, bool accepted)
+{
+    setBit(statuses, status, accepted);
+    updateAction(status);
+}
+
+void
+MessageFilter::updateAction(quint8 status)
+{
+    Action action;
+    if (! isSet(statuses, status)) {
+        action = ACTION_REJECT;
+    } else if ((status < 0x80) || (status >= 0xf0)) {
+        action = ACTION_ACCEPT;
+    } else if (! (channels & (1U << (status & 0xf)))) {
+        action = ACTION_REJECT;
+    } else {
+        switch (status & 0xf0) {
+        case 0x80:
+        case 0x90:
+        case 0xa0:
+            action = ACTION_CHECK_NOTE;
+            break;
+        case 0xb0:
+            action = ACTION_CHECK_CONTROLLER;
+            break;
+        default:
+            action = ACTION_ACCEPT;
+        }
+    }
+    actions[status] = static_cast<quint8>(action);
+}
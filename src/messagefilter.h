@@ -0,0 +1,122 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __MESSAGEFILTER_H__
+#define __MESSAGEFILTER_H__
+
+#include <QtCore/QtGlobal>
+
+// Decides which received MIDI messages are queued.  A filter is made up of a
+// status byte mask, a MIDI channel mask, and note and controller masks that
+// apply to note and control change messages.
+//
+// The masks are compiled into a table that maps each status byte to the check
+// that's needed for messages with that status byte, so accepting or rejecting
+// a message takes at most two table lookups.  Messages with missing or
+// invalid data bytes are never rejected by the note and controller masks, so
+// that malformed messages stay visible.
+
+class MessageFilter {
+
+public:
+
+    MessageFilter();
+
+    ~MessageFilter();
+
+    bool
+    accepts(const quint8 *message, quint32 length) const
+    {
+        if (! length) {
+            return true;
+        }
+        switch (actions[message[0]]) {
+        case ACTION_ACCEPT:
+            return true;
+        case ACTION_CHECK_CONTROLLER:
+            return (length < 2) || (message[1] & 0x80) ||
+                isSet(controllers, message[1]);
+        case ACTION_CHECK_NOTE:
+            return (length < 2) || (message[1] & 0x80) ||
+                isSet(notes, message[1]);
+        default:
+            return false;
+        }
+    }
+
+    bool
+    isChannelAccepted(int channel) const;
+
+    bool
+    isControllerAccepted(quint8 controller) const;
+
+    bool
+    isNoteAccepted(quint8 note) const;
+
+    bool
+    isStatusAccepted(quint8 status) const;
+
+    bool
+    operator==(const MessageFilter &filter) const;
+
+    bool
+    operator!=(const MessageFilter &filter) const;
+
+    void
+    setChannelAccepted(int channel, bool accepted);
+
+    void
+    setControllerAccepted(quint8 controller, bool accepted);
+
+    void
+    setNoteAccepted(quint8 note, bool accepted);
+
+    void
+    setStatusAccepted(quint8 status, bool accepted);
+
+private:
+
+    enum Action {
+        ACTION_REJECT = 0,
+        ACTION_ACCEPT = 1,
+        ACTION_CHECK_CONTROLLER = 2,
+        ACTION_CHECK_NOTE = 3
+    };
+
+    static bool
+    isSet(const quint32 *bits, int index)
+    {
+        return bits[index >> 5] & (1U << (index & 0x1f));
+    }
+
+    static void
+    setBit(quint32 *bits, int index, bool value);
+
+    void
+    updateAction(quint8 status);
+
+    quint8 actions[0x100];
+    quint32 channels;
+    quint32 controllers[4];
+    quint32 notes[4];
+    quint32 statuses[8];
+
+};
+
+#endif
@@ -0,0 +1,265 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+
+#include <QtCore/QStringList>
+
+#include "messagefiltereditor.h"
+#include "util.h"
+
+// Static data
+
+const char *messageTypeNames[] = {
+    QT_TRANSLATE_NOOP("MessageFilterEditor", "Note Off"),
+    QT_TRANSLATE_NOOP("MessageFilterEditor", "Note On"),
+    QT_TRANSLATE_NOOP("MessageFilterEditor", "Polyphonic Pressure"),
+    QT_TRANSLATE_NOOP("MessageFilterEditor", "Control Change"),
+    QT_TRANSLATE_NOOP("MessageFilterEditor", "Program Change"),
+    QT_TRANSLATE_NOOP("MessageFilterEditor", "Channel Pressure"),
+    QT_TRANSLATE_NOOP("MessageFilterEditor", "Pitch Bend"),
+    QT_TRANSLATE_NOOP("MessageFilterEditor", "System Common"),
+    QT_TRANSLATE_NOOP("MessageFilterEditor", "System Real-Time"),
+    QT_TRANSLATE_NOOP("MessageFilterEditor", "System Reset"),
+    QT_TRANSLATE_NOOP("MessageFilterEditor", "Invalid and Undefined")
+};
+
+// Static functions
+
+QString
+MessageFilterEditor::getRangeString(const QVector<bool> &values, int offset)
+{
+    QStringList ranges;
+    int count = values.count();
+    for (int i = 0; i < count; i++) {
+        if (! values[i]) {
+            continue;
+        }
+        int first = i;
+        while (((i + 1) < count) && values[i + 1]) {
+            i++;
+        }
+        ranges.append(first == i ? QString::number(first + offset) :
+                      QString("%1-%2").arg(first + offset).arg(i + offset));
+    }
+    return ranges.join(", ");
+}
+
+bool
+MessageFilterEditor::isMessageTypeStatus(int type, int status)
+{
+    assert((type >= 0) && (type < MESSAGETYPE_TOTAL));
+    switch (type) {
+    case MESSAGETYPE_SYSTEM_COMMON:
+        return (status == 0xf2) || (status == 0xf3) || (status == 0xf6);
+    case MESSAGETYPE_SYSTEM_REALTIME:
+        return (status >= 0xfa) && (status <= 0xfc);
+    case MESSAGETYPE_SYSTEM_RESET:
+        return status == 0xff;
+    case MESSAGETYPE_INVALID:
+        return (status < 0x80) || (status == 0xf4) || (status == 0xf5) ||
+            (status == 0xf7) || (status == 0xfd);
+    default:
+        return (status & 0xf0) == (0x80 + (type << 4));
+    }
+}
+
+bool
+MessageFilterEditor::parseRangeString(const QString &text, int offset,
+                                QVector<bool> &values)
+{
+    values.fill(false);
+    int count = values.count();
+    QStringList ranges = text.split(',', QString::SkipEmptyParts);
+    for (int i = 0; i < ranges.count(); i++) {
+        QStringList bounds = ranges[i].split('-');
+        if (bounds.count() > 2) {
+            return false;
+        }
+        bool success;
+        int first = bounds[0].trimmed().toInt(&success) - offset;
+        if (! success) {
+            return false;
+        }
+        int last = first;
+        if (bounds.count() == 2) {
+            last = bounds[1].trimmed().toInt(&success) - offset;
+            if (! success) {
+                return false;
+            }
+        }
+        if ((first < 0) || (last >= count) || (first > last)) {
+            return false;
+        }
+        for (int j = first; j <= last; j++) {
+            values[j] = true;
+        }
+    }
+    return true;
+}
+
+// Class definition
+
+MessageFilterEditor::MessageFilterEditor(QWidget *rootWidget,
+                                         QObject *parent):
+    QObject(parent)
+{
+    channels = getChild<QLineEdit>(rootWidget, "channels");
+    connect(channels, SIGNAL(editingFinished()), SLOT(handleChannelsEdit()));
+
+    controllers = getChild<QLineEdit>(rootWidget, "controllers");
+    connect(controllers, SIGNAL(editingFinished()),
+            SLOT(handleControllersEdit()));
+
+    messageTypes = getChild<QListWidget>(rootWidget, "messageTypes");
+    for (int i = 0; i < MESSAGETYPE_TOTAL; i++) {
+        QListWidgetItem *item = new QListWidgetItem(tr(messageTypeNames[i]));
+        item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable);
+        messageTypes->addItem(item);
+    }
+    connect(messageTypes, SIGNAL(itemChanged(QListWidgetItem *)),
+            SLOT(handleMessageTypeChange(QListWidgetItem *)));
+
+    notes = getChild<QLineEdit>(rootWidget, "notes");
+    connect(notes, SIGNAL(editingFinished()), SLOT(handleNotesEdit()));
+
+    updateWidgets();
+}
+
+MessageFilterEditor::~MessageFilterEditor()
+{
+    // Empty
+}
+
+const MessageFilter &
+MessageFilterEditor::getFilter() const
+{
+    return messageFilter;
+}
+
+
+void
+MessageFilterEditor::handleChannelsEdit()
+{
+    QVector<bool> values(16);
+    if (! parseRangeString(channels->text(), 1, values)) {
+        updateWidgets();
+        return;
+    }
+    MessageFilter filter(messageFilter);
+    for (int i = 0; i < 16; i++) {
+        filter.setChannelAccepted(i, values[i]);
+    }
+    if (filter != messageFilter) {
+        emit filterChangeRequest(filter);
+    }
+}
+
+void
+MessageFilterEditor::handleControllersEdit()
+{
+    QVector<bool> values(0x80);
+    if (! parseRangeString(controllers->text(), 0, values)) {
+        updateWidgets();
+        return;
+    }
+    MessageFilter filter(messageFilter);
+    for (int i = 0; i < 0x80; i++) {
+        filter.setControllerAccepted(static_cast<quint8>(i), values[i]);
+    }
+    if (filter != messageFilter) {
+        emit filterChangeRequest(filter);
+    }
+}
+
+void
+MessageFilterEditor::handleMessageTypeChange(QListWidgetItem *item)
+{
+    // The check box is put back the way it was until the new filter is set.
+    bool accepted = item->checkState() == Qt::Checked;
+    messageTypes->blockSignals(true);
+    item->setCheckState(accepted ? Qt::Unchecked : Qt::Checked);
+    messageTypes->blockSignals(false);
+    int type = messageTypes->row(item);
+    MessageFilter filter(messageFilter);
+    for (int i = 0; i < 0x100; i++) {
+        if (isMessageTypeStatus(type, i)) {
+            filter.setStatusAccepted(static_cast<quint8>(i), accepted);
+        }
+    }
+    emit filterChangeRequest(filter);
+}
+
+void
+MessageFilterEditor::handleNotesEdit()
+{
+    QVector<bool> values(0x80);
+    if (! parseRangeString(notes->text(), 0, values)) {
+        updateWidgets();
+        return;
+    }
+    MessageFilter filter(messageFilter);
+    for (int i = 0; i < 0x80; i++) {
+        filter.setNoteAccepted(static_cast<quint8>(i), values[i]);
+    }
+    if (filter != messageFilter) {
+        emit filterChangeRequest(filter);
+    }
+}
+
+void
+MessageFilterEditor::setFilter(const MessageFilter &filter)
+{
+    messageFilter = filter;
+    updateWidgets();
+}
+
+void
+MessageFilterEditor::updateWidgets()
+{
+    QVector<bool> values(16);
+    for (int i = 0; i < 16; i++) {
+        values[i] = messageFilter.isChannelAccepted(i);
+    }
+    channels->setText(getRangeString(values, 1));
+    values.resize(0x80);
+    for (int i = 0; i < 0x80; i++) {
+        values[i] = messageFilter.isControllerAccepted(static_cast<quint8>(i));
+    }
+    controllers->setText(getRangeString(values, 0));
+    for (int i = 0; i < 0x80; i++) {
+        values[i] = messageFilter.isNoteAccepted(static_cast<quint8>(i));
+    }
+    notes->setText(getRangeString(values, 0));
+
+    // A message type is checked if every status byte of the type is accepted.
+    messageTypes->blockSignals(true);
+    for (int i = 0; i < MESSAGETYPE_TOTAL; i++) {
+        bool accepted = true;
+        for (int j = 0; accepted && (j < 0x100); j++) {
+            if (isMessageTypeStatus(i, j)) {
+                accepted =
+                    messageFilter.isStatusAccepted(static_cast<quint8>(j));
+            }
+        }
+        messageTypes->item(i)->setCheckState(accepted ? Qt::Checked :
+                                             Qt::Unchecked);
+    }
+    messageTypes->blockSignals(false);
+}
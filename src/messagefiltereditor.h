@@ -0,0 +1,111 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __MESSAGEFILTEREDITOR_H__
+#define __MESSAGEFILTEREDITOR_H__
+
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+#include <QtWidgets/QLineEdit>
+#include <QtWidgets/QListWidget>
+
+#include "messagefilter.h"
+
+// Edits a `MessageFilter` with the `messageTypes` list and the `channels`,
+// `notes` and `controllers` line edits found under a view's root widget.
+// Edits are requested with `filterChangeRequest`, and only show up once the
+// new filter is set.
+
+class MessageFilterEditor: public QObject {
+
+    Q_OBJECT
+
+public:
+
+    explicit
+    MessageFilterEditor(QWidget *rootWidget, QObject *parent=0);
+
+    ~MessageFilterEditor();
+
+    const MessageFilter &
+    getFilter() const;
+
+public slots:
+
+    void
+    setFilter(const MessageFilter &filter);
+
+signals:
+
+    void
+    filterChangeRequest(const MessageFilter &filter);
+
+private slots:
+
+    void
+    handleChannelsEdit();
+
+    void
+    handleControllersEdit();
+
+    void
+    handleMessageTypeChange(QListWidgetItem *item);
+
+    void
+    handleNotesEdit();
+
+private:
+
+    enum MessageType {
+        MESSAGETYPE_NOTE_OFF = 0,
+        MESSAGETYPE_NOTE_ON = 1,
+        MESSAGETYPE_POLYPHONIC_PRESSURE = 2,
+        MESSAGETYPE_CONTROL_CHANGE = 3,
+        MESSAGETYPE_PROGRAM_CHANGE = 4,
+        MESSAGETYPE_CHANNEL_PRESSURE = 5,
+        MESSAGETYPE_PITCH_BEND = 6,
+        MESSAGETYPE_SYSTEM_COMMON = 7,
+        MESSAGETYPE_SYSTEM_REALTIME = 8,
+        MESSAGETYPE_SYSTEM_RESET = 9,
+        MESSAGETYPE_INVALID = 10,
+
+        MESSAGETYPE_TOTAL = 11
+    };
+
+    static QString
+    getRangeString(const QVector<bool> &values, int offset);
+
+    static bool
+    isMessageTypeStatus(int type, int status);
+
+    static bool
+    parseRangeString(const QString &text, int offset, QVector<bool> &values);
+
+    void
+    updateWidgets();
+
+    QLineEdit *channels;
+    QLineEdit *controllers;
+    MessageFilter messageFilter;
+    QListWidget *messageTypes;
+    QLineEdit *notes;
+
+};
+
+#endif
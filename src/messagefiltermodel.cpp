@@ -0,0 +1,388 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include <QtCore/QRunnable>
+
+#include "messagefiltermodel.h"
+
+// Static data
+
+// How many pages a single job searches.
+static const int chunkPageCount = 64;
+
+// How often finished chunks are merged, in milliseconds.
+static const int mergeInterval = 16;
+
+// Job class
+
+class MessageFilterModel::ChunkJob: public QRunnable {
+
+public:
+
+    ChunkJob(const QSharedPointer<Search> &search, Chunk &chunk):
+        chunk(chunk),
+        search(search)
+    {
+        // Empty
+    }
+
+    void
+    run()
+    {
+        int count = chunk.indexes.count();
+        for (int i = 0; i < count; i++) {
+            if (search->cancelled.loadAcquire()) {
+                break;
+            }
+            chunk.indexes[i]->
+                findMessages(search->filter,
+                             chunk.firstRow +
+                             (i * MessageTableModel::PAGE_SIZE),
+                             chunk.rows);
+        }
+        chunk.done.storeRelease(1);
+    }
+
+private:
+
+    Chunk &chunk;
+    QSharedPointer<Search> search;
+
+};
+
+// Class definition
+
+MessageFilterModel::MessageFilterModel(MessageTableModel &messageModel,
+                                       QObject *parent):
+    QAbstractProxyModel(parent),
+    messageModel(messageModel)
+{
+    nextChunk = 0;
+    removedRows = 0;
+    setSourceModel(&messageModel);
+    connect(&messageModel,
+            SIGNAL(dataChanged(const QModelIndex &, const QModelIndex &)),
+            SLOT(handleSourceDataChange(const QModelIndex &,
+                                        const QModelIndex &)));
+    connect(&messageModel,
+            SIGNAL(headerDataChanged(Qt::Orientation, int, int)),
+            SLOT(handleSourceHeaderDataChange(Qt::Orientation, int, int)));
+    connect(&messageModel, SIGNAL(layoutChanged()),
+            SLOT(handleSourceLayoutChange()));
+    connect(&messageModel, SIGNAL(modelReset()), SLOT(handleSourceReset()));
+    connect(&messageModel, SIGNAL(rowsInserted(const QModelIndex &, int, int)),
+            SLOT(handleSourceRowInsertion(const QModelIndex &, int, int)));
+    connect(&messageModel,
+            SIGNAL(rowsAboutToBeRemoved(const QModelIndex &, int, int)),
+            SLOT(handleSourceRowRemovalStart(const QModelIndex &, int, int)));
+    connect(&messageModel, SIGNAL(rowsRemoved(const QModelIndex &, int, int)),
+            SLOT(handleSourceRowRemoval(const QModelIndex &, int, int)));
+    connect(&mergeTimer, SIGNAL(timeout()), SLOT(mergeChunks()));
+    mergeTimer.setInterval(mergeInterval);
+}
+
+MessageFilterModel::~MessageFilterModel()
+{
+    cancelSearch();
+}
+
+void
+MessageFilterModel::appendRows(const QVector<qint64> &newRows)
+{
+    // Rows that were evicted before they could be shown are skipped.
+    int first = static_cast<int>(std::lower_bound(newRows.constBegin(),
+                                                  newRows.constEnd(),
+                                                  removedRows) -
+                                 newRows.constBegin());
+    int count = newRows.count() - first;
+    if (count > 0) {
+        int rowCount = rows.count();
+        beginInsertRows(QModelIndex(), rowCount, rowCount + count - 1);
+        rows += first ? newRows.mid(first) : newRows;
+        endInsertRows();
+    }
+}
+
+void
+MessageFilterModel::cancelSearch()
+{
+    if (search) {
+        search->cancelled.storeRelease(1);
+        threadPool.clear();
+        search.clear();
+    }
+    mergeTimer.stop();
+    nextChunk = 0;
+    pendingRows.clear();
+}
+
+int
+MessageFilterModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : messageModel.columnCount();
+}
+
+int
+MessageFilterModel::findRow(qint64 row) const
+{
+    return static_cast<int>(std::lower_bound(rows.constBegin(),
+                                             rows.constEnd(), row) -
+                            rows.constBegin());
+}
+
+const MessageFilter &
+MessageFilterModel::getFilter() const
+{
+    return filter;
+}
+
+void
+MessageFilterModel::handleSourceDataChange(const QModelIndex &topLeft,
+                                           const QModelIndex &bottomRight)
+{
+    // Only the shown rows in the changed range are reported.
+    int first = findRow(topLeft.row() + removedRows);
+    int end = findRow(bottomRight.row() + removedRows + 1);
+    if (first < end) {
+        emit dataChanged(index(first, topLeft.column()),
+                         index(end - 1, bottomRight.column()));
+    }
+}
+
+void
+MessageFilterModel::handleSourceHeaderDataChange
+(Qt::Orientation orientation, int first, int last)
+{
+    if (orientation == Qt::Horizontal) {
+        emit headerDataChanged(orientation, first, last);
+        return;
+    }
+    int firstRow = findRow(first + removedRows);
+    int end = findRow(last + removedRows + 1);
+    if (firstRow < end) {
+        emit headerDataChanged(orientation, firstRow, end - 1);
+    }
+}
+
+void
+MessageFilterModel::handleSourceLayoutChange()
+{
+    // The message model's rows may have moved, so the rows that are shown
+    // are found again.
+    setFilter(filter);
+}
+
+void
+MessageFilterModel::handleSourceReset()
+{
+    cancelSearch();
+    beginResetModel();
+    removedRows = 0;
+    rows.clear();
+    endResetModel();
+    emit searchProgressChanged(0, 0);
+}
+
+void
+MessageFilterModel::handleSourceRowInsertion(const QModelIndex &/*parent*/,
+                                             int first, int last)
+{
+    // Rows are kept as they were numbered before any rows were evicted, so
+    // that evicting rows doesn't renumber the rest.
+    QVector<qint64> added;
+    for (int i = first; i <= last; i++) {
+        if (messageModel.isMessageAccepted(i, filter)) {
+            added.append(i + removedRows);
+        }
+    }
+    if (search) {
+        pendingRows += added;
+    } else {
+        appendRows(added);
+    }
+}
+
+void
+MessageFilterModel::handleSourceRowRemoval(const QModelIndex &/*parent*/,
+                                           int first, int last)
+{
+    // Only the oldest rows are ever removed.
+    assert(! first);
+    int end = findRow(removedRows + last + 1);
+    removedRows += last + 1;
+    if (end) {
+        rows.remove(0, end);
+        endRemoveRows();
+    }
+}
+
+void
+MessageFilterModel::handleSourceRowRemovalStart
+(const QModelIndex &/*parent*/, int first, int last)
+{
+    assert(! first);
+    int end = findRow(removedRows + last + 1);
+    if (end) {
+        beginRemoveRows(QModelIndex(), 0, end - 1);
+    }
+}
+
+QVariant
+MessageFilterModel::headerData(int section, Qt::Orientation orientation,
+                               int role) const
+{
+    // Columns are the same as the message model's, even when no rows are
+    // shown.  Rows are numbered as they are in the message model.
+    if (orientation == Qt::Horizontal) {
+        return messageModel.headerData(section, orientation, role);
+    }
+    return QAbstractProxyModel::headerData(section, orientation, role);
+}
+
+QModelIndex
+MessageFilterModel::index(int row, int column,
+                          const QModelIndex &parent) const
+{
+    if (parent.isValid() || (row < 0) || (row >= rows.count()) ||
+        (column < 0) || (column >= columnCount())) {
+        return QModelIndex();
+    }
+    return createIndex(row, column);
+}
+
+QModelIndex
+MessageFilterModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (! sourceIndex.isValid()) {
+        return QModelIndex();
+    }
+    qint64 row = sourceIndex.row() + removedRows;
+    int position = findRow(row);
+    if ((position == rows.count()) || (rows[position] != row)) {
+        return QModelIndex();
+    }
+    return createIndex(position, sourceIndex.column());
+}
+
+QModelIndex
+MessageFilterModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (! proxyIndex.isValid()) {
+        return QModelIndex();
+    }
+    return messageModel.index(static_cast<int>(rows[proxyIndex.row()] -
+                                               removedRows),
+                              proxyIndex.column());
+}
+
+void
+MessageFilterModel::mergeChunks()
+{
+    assert(search);
+    QVector<qint64> found;
+    int chunkCount = search->chunks.count();
+    for (; nextChunk < chunkCount; nextChunk++) {
+        Chunk *chunk = search->chunks[nextChunk];
+        if (! chunk->done.loadAcquire()) {
+            break;
+        }
+        found += chunk->rows;
+        chunk->indexes.clear();
+        chunk->rows.clear();
+    }
+    if (nextChunk == chunkCount) {
+        found += pendingRows;
+        pendingRows.clear();
+        mergeTimer.stop();
+        search.clear();
+    }
+    appendRows(found);
+    emit searchProgressChanged(nextChunk, chunkCount);
+}
+
+QModelIndex
+MessageFilterModel::parent(const QModelIndex &/*index*/) const
+{
+    return QModelIndex();
+}
+
+int
+MessageFilterModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows.count();
+}
+
+void
+MessageFilterModel::setFilter(const MessageFilter &filter)
+{
+    cancelSearch();
+    beginResetModel();
+    this->filter = filter;
+    rows.clear();
+    endResetModel();
+    startSearch();
+}
+
+void
+MessageFilterModel::startSearch()
+{
+    assert(! search);
+    search = QSharedPointer<Search>(new Search());
+    search->cancelled.store(0);
+    search->filter = filter;
+
+    // Full pages are searched on the thread pool, a chunk of pages at a
+    // time, and in order, so the first rows are found first.
+    // Rows that were evicted from the first page are found too, and are
+    // skipped when they're merged.
+    int firstRow;
+    QList<QSharedPointer<const MessageIndex> > indexes =
+        messageModel.getFullPageIndexes(firstRow);
+    int pageCount = indexes.count();
+    for (int i = 0; i < pageCount; i += chunkPageCount) {
+        Chunk *chunk = new Chunk();
+        chunk->done.store(0);
+        chunk->firstRow = firstRow + (i * MessageTableModel::PAGE_SIZE) +
+            removedRows;
+        chunk->indexes = indexes.mid(i, chunkPageCount);
+        search->chunks.append(chunk);
+    }
+    for (int i = 0; i < search->chunks.count(); i++) {
+        threadPool.start(new ChunkJob(search, *(search->chunks[i])));
+    }
+
+    // The rest of the rows are in the last page, which is still being
+    // filled, so they're checked here.
+    int rowCount = messageModel.rowCount();
+    for (int i = qMax(firstRow + (pageCount * MessageTableModel::PAGE_SIZE),
+                      0);
+         i < rowCount; i++) {
+        if (messageModel.isMessageAccepted(i, filter)) {
+            pendingRows.append(i + removedRows);
+        }
+    }
+
+    mergeChunks();
+    if (search) {
+        mergeTimer.start();
+    }
+}
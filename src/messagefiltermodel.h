@@ -0,0 +1,183 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __MESSAGEFILTERMODEL_H__
+#define __MESSAGEFILTERMODEL_H__
+
+#include <QtCore/QAbstractProxyModel>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QList>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+
+#include "messagefilter.h"
+#include "messagetablemodel.h"
+
+// Shows the rows of a `MessageTableModel` that are accepted by a filter.  No
+// rows are shown until the filter is set.
+//
+// When the filter changes, the indexes of the message model's full pages are
+// searched in chunks on a thread pool.  Finished chunks are merged in order
+// on the GUI thread, so matching rows show up while the search goes on.
+// Changing the filter again abandons the search: queued chunks are dropped,
+// and running ones stop at their next page.
+//
+// Rows that aren't covered by the search, including messages added while it
+// runs, are checked one at a time on the GUI thread, and are shown once the
+// search is finished.  Evicted messages are dropped from the front of the
+// row list.  Rows are kept as 64-bit numbers, which count every message the
+// message model has ever held, so they don't wrap around however long
+// messages are captured for.
+//
+// Changes to the message model's rows and headers are passed on for the
+// rows that are shown.  A change to the message model's layout starts the
+// search over.
+
+class MessageFilterModel: public QAbstractProxyModel {
+
+    Q_OBJECT
+
+public:
+
+    explicit
+    MessageFilterModel(MessageTableModel &messageModel, QObject *parent=0);
+
+    ~MessageFilterModel();
+
+    int
+    columnCount(const QModelIndex &parent=QModelIndex()) const;
+
+    const MessageFilter &
+    getFilter() const;
+
+    QVariant
+    headerData(int section, Qt::Orientation orientation,
+               int role=Qt::DisplayRole) const;
+
+    QModelIndex
+    index(int row, int column, const QModelIndex &parent=QModelIndex()) const;
+
+    QModelIndex
+    mapFromSource(const QModelIndex &sourceIndex) const;
+
+    QModelIndex
+    mapToSource(const QModelIndex &proxyIndex) const;
+
+    QModelIndex
+    parent(const QModelIndex &index) const;
+
+    int
+    rowCount(const QModelIndex &parent=QModelIndex()) const;
+
+    void
+    setFilter(const MessageFilter &filter);
+
+signals:
+
+    // `finished` chunks out of `total` have been merged.  The search is over
+    // when they're equal.
+    void
+    searchProgressChanged(int finished, int total);
+
+private slots:
+
+    void
+    handleSourceDataChange(const QModelIndex &topLeft,
+                           const QModelIndex &bottomRight);
+
+    void
+    handleSourceHeaderDataChange(Qt::Orientation orientation, int first,
+                                 int last);
+
+    void
+    handleSourceLayoutChange();
+
+    void
+    handleSourceReset();
+
+    void
+    handleSourceRowInsertion(const QModelIndex &parent, int first, int last);
+
+    void
+    handleSourceRowRemoval(const QModelIndex &parent, int first, int last);
+
+    void
+    handleSourceRowRemovalStart(const QModelIndex &parent, int first,
+                                int last);
+
+    void
+    mergeChunks();
+
+private:
+
+    // Consecutive pages searched by a single job, and the rows found in them.
+    struct Chunk {
+        QAtomicInt done;
+        qint64 firstRow;
+        QList<QSharedPointer<const MessageIndex> > indexes;
+        QVector<qint64> rows;
+    };
+
+    // The state shared with the jobs of a search.  It's freed by whoever
+    // lets go of it last, so an abandoned search doesn't have to be waited
+    // for.
+    struct Search {
+
+        ~Search()
+        {
+            qDeleteAll(chunks);
+        }
+
+        QAtomicInt cancelled;
+        QList<Chunk *> chunks;
+        MessageFilter filter;
+
+    };
+
+    class ChunkJob;
+
+    void
+    appendRows(const QVector<qint64> &newRows);
+
+    void
+    cancelSearch();
+
+    // Returns the position of the first row in `rows` that isn't less than
+    // `row`.
+    int
+    findRow(qint64 row) const;
+
+    void
+    startSearch();
+
+    MessageFilter filter;
+    QTimer mergeTimer;
+    MessageTableModel &messageModel;
+    int nextChunk;
+    QVector<qint64> pendingRows;
+    qint64 removedRows;
+    QVector<qint64> rows;
+    QSharedPointer<Search> search;
+    QThreadPool threadPool;
+
+};
+
+#endif
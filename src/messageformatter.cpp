@@ -0,0 +1,334 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+
+#include "bytes.h"
+#include "messageformatter.h"
+#include "nametables.h"
+#include "sysexdecoderregistry.h"
+
+QString
+MessageFormatter::getAnnotationDescription(const Annotation &annotation)
+{
+    quint32 value = annotation.value;
+    switch (annotation.kind) {
+    case Annotation::KIND_CONTROL_CHANGE_14_BIT:
+        return tr("Controller %1 (14-bit): %2").arg(annotation.number).
+            arg(value);
+    case Annotation::KIND_NRPN:
+        return tr("NRPN %1/%2: %3").arg(annotation.number >> 7).
+            arg(annotation.number & 0x7f).arg(value);
+    case Annotation::KIND_RPN:
+        return tr("RPN %1/%2: %3").arg(annotation.number >> 7).
+            arg(annotation.number & 0x7f).arg(value);
+    case Annotation::KIND_TIMECODE:
+        return tr("Timecode: %1:%2:%3:%4 (%5)").
+            arg(value >> 24, 2, 10, QChar('0')).
+            arg((value >> 16) & 0xff, 2, 10, QChar('0')).
+            arg((value >> 8) & 0xff, 2, 10, QChar('0')).
+            arg(value & 0xff, 2, 10, QChar('0')).
+            arg(getSMPTETypeString(annotation.number));
+    default:
+        return QString();
+    }
+}
+
+QString
+MessageFormatter::getDataDescription(const DecodedMessage &decoded,
+                                     const quint8 *message)
+{
+    NameTables &names = NameTables::getInstance();
+    switch (decoded.kind) {
+
+    case DecodedMessage::KIND_INVALID_STATUS:
+    case DecodedMessage::KIND_UNDEFINED_STATUS:
+    case DecodedMessage::KIND_INCORRECT_LENGTH:
+    case DecodedMessage::KIND_INVALID_DATA:
+    case DecodedMessage::KIND_SYSTEM_EXCLUSIVE_NO_END:
+        return getGenericDataDescription(message, decoded.dataLength);
+
+    case DecodedMessage::KIND_SYSTEM_EXCLUSIVE:
+        return getSystemExclusiveDescription(message, decoded.dataLength);
+
+    case DecodedMessage::KIND_NOTE_OFF:
+    case DecodedMessage::KIND_NOTE_ON:
+        return tr("Note: %1, Velocity: %2").
+            arg(names.getNoteName(decoded.number)).arg(decoded.value);
+
+    case DecodedMessage::KIND_POLYPHONIC_PRESSURE:
+        return tr("Note: %1, Pressure: %2").
+            arg(names.getNoteName(decoded.number)).arg(decoded.value);
+
+    case DecodedMessage::KIND_CONTROL_CHANGE:
+        return tr("Controller: %1, Value: %2").
+            arg(names.getControlName(decoded.number)).arg(decoded.value);
+
+    case DecodedMessage::KIND_PROGRAM_CHANGE:
+        return tr("Number: %1").arg(decoded.value);
+
+    case DecodedMessage::KIND_CHANNEL_PRESSURE:
+        return tr("Pressure: %1").arg(decoded.value);
+
+    case DecodedMessage::KIND_PITCH_BEND:
+        return tr("Value: %1").arg(decoded.value);
+
+    case DecodedMessage::KIND_MTC_QUARTER_FRAME:
+        switch (decoded.number) {
+        case 0:
+            return tr("Frames Low Nibble: %1").arg(decoded.value);
+        case 1:
+            return tr("Frames High Nibble: %1").arg(decoded.value);
+        case 2:
+            return tr("Seconds Low Nibble: %1").arg(decoded.value);
+        case 3:
+            return tr("Seconds High Nibble: %1").arg(decoded.value);
+        case 4:
+            return tr("Minutes Low Nibble: %1").arg(decoded.value);
+        case 5:
+            return tr("Minutes High Nibble: %1").arg(decoded.value);
+        case 6:
+            return tr("Hours Low Nibble: %1").arg(decoded.value);
+        default:
+            ;
+        }
+        return tr("Hours High Nibble: %1, SMPTE Type: %2").
+            arg(decoded.value & 1).
+            arg(getSMPTETypeString((decoded.value & 0x6) >> 1));
+
+    case DecodedMessage::KIND_SONG_POSITION_POINTER:
+        return tr("MIDI Beat: %1").arg(decoded.value);
+
+    case DecodedMessage::KIND_SONG_SELECT:
+        return tr("Song Number: %1").arg(decoded.value);
+
+    default:
+        return QString();
+    }
+}
+
+QString
+MessageFormatter::getGenericDataDescription(const quint8 *message,
+                                            int dataLength)
+{
+    QString bytes = tr("(%1 bytes)").arg(dataLength);
+    if (! dataLength) {
+        return bytes;
+    }
+    return getHexString(message + 1, dataLength) + ' ' + bytes;
+}
+
+QString
+MessageFormatter::getHexString(const quint8 *data, int length)
+{
+    QString s(getHexStringLength(length), Qt::Uninitialized);
+    writeHexString(data, length, s.data());
+    return s;
+}
+
+QString
+MessageFormatter::getSMPTETypeString(int type)
+{
+    switch (type) {
+    case 0:
+        return tr("24 fps");
+    case 1:
+        return tr("25 fps");
+    case 2:
+        return tr("30 fps (drop-frame)");
+    default:
+        return tr("30 fps");
+    }
+}
+
+QString
+MessageFormatter::getStatusDescription(const DecodedMessage &decoded)
+{
+    switch (decoded.kind) {
+    case DecodedMessage::KIND_EMPTY:
+        return tr("empty message");
+    case DecodedMessage::KIND_INVALID_STATUS:
+        return tr("%1 (invalid status)").
+            arg(static_cast<uint>(decoded.status), 2, 16, QChar('0'));
+    case DecodedMessage::KIND_UNDEFINED_STATUS:
+        return tr("%1 (undefined status)").
+            arg(static_cast<uint>(decoded.status), 2, 16, QChar('0'));
+    case DecodedMessage::KIND_INCORRECT_LENGTH:
+        return tr("%1 (incorrect length)").
+            arg(static_cast<uint>(decoded.status), 2, 16, QChar('0'));
+    case DecodedMessage::KIND_INVALID_DATA:
+        return tr("%1 (invalid data)").
+            arg(static_cast<uint>(decoded.status), 2, 16, QChar('0'));
+    case DecodedMessage::KIND_SYSTEM_EXCLUSIVE_NO_DATA:
+        return tr("System Exclusive (no data)");
+    case DecodedMessage::KIND_SYSTEM_EXCLUSIVE_NO_END:
+        return tr("System Exclusive (end not found)");
+    case DecodedMessage::KIND_NOTE_OFF:
+    case DecodedMessage::KIND_NOTE_ON:
+    case DecodedMessage::KIND_POLYPHONIC_PRESSURE:
+    case DecodedMessage::KIND_CONTROL_CHANGE:
+    case DecodedMessage::KIND_PROGRAM_CHANGE:
+    case DecodedMessage::KIND_CHANNEL_PRESSURE:
+    case DecodedMessage::KIND_PITCH_BEND:
+        return NameTables::getInstance().getChannelStatusName(decoded.status);
+    case DecodedMessage::KIND_SYSTEM_EXCLUSIVE:
+        return tr("System Exclusive");
+    case DecodedMessage::KIND_MTC_QUARTER_FRAME:
+        return tr("MTC Quarter Frame");
+    case DecodedMessage::KIND_SONG_POSITION_POINTER:
+        return tr("Song Position Pointer");
+    case DecodedMessage::KIND_SONG_SELECT:
+        return tr("Song Select");
+    case DecodedMessage::KIND_TUNE_REQUEST:
+        return tr("Tune Request");
+    case DecodedMessage::KIND_CLOCK:
+        return tr("MIDI Clock");
+    case DecodedMessage::KIND_TICK:
+        return tr("MIDI Tick");
+    case DecodedMessage::KIND_START:
+        return tr("MIDI Start");
+    case DecodedMessage::KIND_CONTINUE:
+        return tr("MIDI Continue");
+    case DecodedMessage::KIND_STOP:
+        return tr("MIDI Stop");
+    case DecodedMessage::KIND_ACTIVE_SENSING:
+        return tr("Active Sense");
+    case DecodedMessage::KIND_RESET:
+        return tr("Reset");
+    }
+
+    // We shouldn't get here.
+    assert(false);
+    return QString();
+}
+
+QString
+MessageFormatter::getSystemExclusiveDescription(const quint8 *message,
+                                                int dataLength)
+{
+    QString generic = getGenericDataDescription(message, dataLength);
+    QString description = SysExDecoderRegistry::getInstance().
+        decode(message + 1, static_cast<quint32>(dataLength));
+    return description.isNull() ? generic :
+        tr("%1 - %2").arg(description, generic);
+}
+
+QString
+MessageFormatter::getTimeString(qint64 time)
+{
+    quint64 magnitude = static_cast<quint64>(time < 0 ? -time : time);
+    return QString("%1%2.%3").arg(time < 0 ? "-" : "").
+        arg(magnitude / 1000000).
+        arg(magnitude % 1000000, 6, 10, QChar('0'));
+}
+
+QString
+MessageFormatter::getUMPDescription(const DecodedUMPMessage &decoded)
+{
+    NameTables &names = NameTables::getInstance();
+    QString address = tr("Group %1, Channel %2").arg(decoded.group + 1).
+        arg(decoded.channel + 1);
+    QString note;
+    switch (decoded.kind) {
+    case DecodedUMPMessage::KIND_NOTE_OFF:
+    case DecodedUMPMessage::KIND_NOTE_ON:
+        note = tr("%1 (%2): Note: %3, Velocity: %4").
+            arg(decoded.kind == DecodedUMPMessage::KIND_NOTE_ON ?
+                tr("Note On") : tr("Note Off"), address,
+                names.getNoteName(decoded.number)).
+            arg(decoded.value);
+        if (decoded.attributeType) {
+            note = tr("%1, Attribute %2: %3").arg(note).
+                arg(decoded.attributeType).arg(decoded.attribute);
+        }
+        return note;
+    case DecodedUMPMessage::KIND_POLYPHONIC_PRESSURE:
+        return tr("Polyphonic Pressure (%1): Note: %2, Pressure: %3").
+            arg(address, names.getNoteName(decoded.number)).
+            arg(decoded.value);
+    case DecodedUMPMessage::KIND_REGISTERED_PER_NOTE_CONTROLLER:
+        return tr("Registered Per-Note Controller (%1): Note: %2, "
+                  "Controller: %3, Value: %4").
+            arg(address, names.getNoteName(decoded.number)).
+            arg(decoded.bank).arg(decoded.value);
+    case DecodedUMPMessage::KIND_ASSIGNABLE_PER_NOTE_CONTROLLER:
+        return tr("Assignable Per-Note Controller (%1): Note: %2, "
+                  "Controller: %3, Value: %4").
+            arg(address, names.getNoteName(decoded.number)).
+            arg(decoded.bank).arg(decoded.value);
+    case DecodedUMPMessage::KIND_REGISTERED_CONTROLLER:
+        return tr("RPN %1/%2 (%3): %4").arg(decoded.bank).
+            arg(decoded.number).arg(address).arg(decoded.value);
+    case DecodedUMPMessage::KIND_ASSIGNABLE_CONTROLLER:
+        return tr("NRPN %1/%2 (%3): %4").arg(decoded.bank).
+            arg(decoded.number).arg(address).arg(decoded.value);
+    case DecodedUMPMessage::KIND_RELATIVE_REGISTERED_CONTROLLER:
+        return tr("Relative RPN %1/%2 (%3): %4").arg(decoded.bank).
+            arg(decoded.number).arg(address).
+            arg(static_cast<qint32>(decoded.value));
+    case DecodedUMPMessage::KIND_RELATIVE_ASSIGNABLE_CONTROLLER:
+        return tr("Relative NRPN %1/%2 (%3): %4").arg(decoded.bank).
+            arg(decoded.number).arg(address).
+            arg(static_cast<qint32>(decoded.value));
+    case DecodedUMPMessage::KIND_PER_NOTE_PITCH_BEND:
+        return tr("Per-Note Pitch Bend (%1): Note: %2, Value: %3").
+            arg(address, names.getNoteName(decoded.number)).
+            arg(static_cast<qint64>(decoded.value) - 0x80000000LL);
+    case DecodedUMPMessage::KIND_CONTROL_CHANGE:
+        return tr("Control Change (%1): Controller: %2, Value: %3").
+            arg(address, names.getControlName(decoded.number)).
+            arg(decoded.value);
+    case DecodedUMPMessage::KIND_PROGRAM_CHANGE:
+        if (decoded.bank) {
+            return tr("Program Change (%1): Program: %2, Bank: %3/%4").
+                arg(address).arg(decoded.number).
+                arg(decoded.attribute >> 8).arg(decoded.attribute & 0x7f);
+        }
+        return tr("Program Change (%1): Program: %2").arg(address).
+            arg(decoded.number);
+    case DecodedUMPMessage::KIND_CHANNEL_PRESSURE:
+        return tr("Channel Pressure (%1): Pressure: %2").arg(address).
+            arg(decoded.value);
+    case DecodedUMPMessage::KIND_PITCH_BEND:
+        return tr("Pitch Bend (%1): Value: %2").arg(address).
+            arg(static_cast<qint64>(decoded.value) - 0x80000000LL);
+    case DecodedUMPMessage::KIND_PER_NOTE_MANAGEMENT:
+        return tr("Per-Note Management (%1): Note: %2, Detach: %3, "
+                  "Reset: %4").
+            arg(address, names.getNoteName(decoded.number),
+                (decoded.attribute & 0x2) ? tr("yes") : tr("no"),
+                (decoded.attribute & 0x1) ? tr("yes") : tr("no"));
+    default:
+        return QString();
+    }
+}
+
+QString
+MessageFormatter::getUMPHexString(const quint32 *words, int count)
+{
+    QString s;
+    s.reserve(count * 9);
+    for (int i = 0; i < count; i++) {
+        if (i) {
+            s += ' ';
+        }
+        s += QString::number(words[i], 16).rightJustified(8, QChar('0'));
+    }
+    return s;
+}
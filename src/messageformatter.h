@@ -0,0 +1,81 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __MESSAGEFORMATTER_H__
+#define __MESSAGEFORMATTER_H__
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QString>
+
+#include "messageannotator.h"
+#include "messagedecoder.h"
+#include "umpdecoder.h"
+
+// Turns decoded MIDI messages, and their annotations, into user-friendly
+// text.  Message descriptions used to be built by `Controller`, so the
+// formatter's strings keep that class's translation context, and existing
+// translations still apply.
+
+class MessageFormatter {
+
+    Q_DECLARE_TR_FUNCTIONS(Controller)
+
+public:
+
+    static QString
+    getAnnotationDescription(const Annotation &annotation);
+
+    // `message` is the message that was decoded.  It's only used for the
+    // data bytes of invalid messages and system exclusive messages.  System
+    // exclusive messages known to `SysExDecoderRegistry` are described as
+    // well.
+    static QString
+    getDataDescription(const DecodedMessage &decoded, const quint8 *message);
+
+    static QString
+    getHexString(const quint8 *data, int length);
+
+    static QString
+    getSMPTETypeString(int type);
+
+    static QString
+    getStatusDescription(const DecodedMessage &decoded);
+
+    // Returns a time in microseconds as seconds, with six decimal places.
+    static QString
+    getTimeString(qint64 time);
+
+    static QString
+    getUMPDescription(const DecodedUMPMessage &decoded);
+
+    // Returns the words as groups of eight hexadecimal digits.
+    static QString
+    getUMPHexString(const quint32 *words, int count);
+
+private:
+
+    static QString
+    getGenericDataDescription(const quint8 *message, int dataLength);
+
+    static QString
+    getSystemExclusiveDescription(const quint8 *message, int dataLength);
+
+};
+
+#endif
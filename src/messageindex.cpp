@@ -0,0 +1,207 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+
+#include <QtCore/QtAlgorithms>
+
+#include "messageindex.h"
+
+MessageIndex::MessageIndex(int size)
+{
+    assert((size > 0) && (size <= 0x10000));
+    byteCount = 0;
+    wordCount = (size + 63) / 64;
+}
+
+MessageIndex::~MessageIndex()
+{
+    // Empty
+}
+
+void
+MessageIndex::addMessage(int index, const quint8 *message, quint32 length)
+{
+    assert((index >= 0) && (index < (wordCount * 64)));
+    if (! length) {
+        setBit(KEY_EMPTY, index);
+        return;
+    }
+    quint8 status = message[0];
+    setBit(KEY_STATUS + status, index);
+    switch (status & 0xf0) {
+    case 0x80:
+    case 0x90:
+    case 0xa0:
+        if ((length < 2) || (message[1] & 0x80)) {
+            setBit(KEY_MISSING_NUMBER, index);
+        } else {
+            setBit(KEY_NOTE + message[1], index);
+        }
+        break;
+    case 0xb0:
+        if ((length < 2) || (message[1] & 0x80)) {
+            setBit(KEY_MISSING_NUMBER, index);
+        } else {
+            setBit(KEY_CONTROLLER + message[1], index);
+        }
+        break;
+    default:
+        ;
+    }
+}
+
+void
+MessageIndex::addKeyBits(int key, const QVector<quint64> *mask,
+                         QVector<quint64> &bits) const
+{
+    const QVector<quint64> &bitmap = bitmaps[key];
+    if (! bitmap.isEmpty()) {
+        if (mask) {
+            for (int j = 0; j < wordCount; j++) {
+                bits[j] |= bitmap[j] & (*mask)[j];
+            }
+        } else {
+            for (int j = 0; j < wordCount; j++) {
+                bits[j] |= bitmap[j];
+            }
+        }
+        return;
+    }
+    const QVector<quint16> &list = lists[key];
+    for (int i = list.count() - 1; i >= 0; i--) {
+        int index = list[i];
+        quint64 bit = Q_UINT64_C(1) << (index & 0x3f);
+        if ((! mask) || ((*mask)[index >> 6] & bit)) {
+            bits[index >> 6] |= bit;
+        }
+    }
+}
+
+void
+MessageIndex::findMessages(const MessageFilter &filter, qint64 offset,
+                           QVector<qint64> &indexes) const
+{
+    QVector<quint64> result(wordCount, 0);
+    QVector<quint64> controllerMask;
+    QVector<quint64> noteMask;
+    for (int i = 0; i < 0x100; i++) {
+        int key = KEY_STATUS + i;
+        quint8 status = static_cast<quint8>(i);
+        if ((! hasKey(key)) || (! filter.isStatusAccepted(status))) {
+            continue;
+        }
+        if ((status < 0x80) || (status >= 0xf0)) {
+            addKeyBits(key, 0, result);
+            continue;
+        }
+        if (! filter.isChannelAccepted(status & 0xf)) {
+            continue;
+        }
+        const QVector<quint64> *mask;
+        switch (status & 0xf0) {
+        case 0x80:
+        case 0x90:
+        case 0xa0:
+            if (noteMask.isEmpty()) {
+                getNumberMask(filter, KEY_NOTE, noteMask);
+            }
+            mask = &noteMask;
+            break;
+        case 0xb0:
+            if (controllerMask.isEmpty()) {
+                getNumberMask(filter, KEY_CONTROLLER, controllerMask);
+            }
+            mask = &controllerMask;
+            break;
+        default:
+            mask = 0;
+        }
+        addKeyBits(key, mask, result);
+    }
+
+    // Empty messages are never rejected.
+    addKeyBits(KEY_EMPTY, 0, result);
+
+    for (int j = 0; j < wordCount; j++) {
+        quint64 word = result[j];
+        while (word) {
+            indexes.append(offset + (j * 64) + qCountTrailingZeroBits(word));
+            word &= word - 1;
+        }
+    }
+}
+
+qint64
+MessageIndex::getByteCount() const
+{
+    return byteCount;
+}
+
+void
+MessageIndex::getNumberMask(const MessageFilter &filter, int key,
+                            QVector<quint64> &mask) const
+{
+    // Messages without a usable data byte aren't rejected by the note and
+    // controller masks.
+    mask.fill(0, wordCount);
+    addKeyBits(KEY_MISSING_NUMBER, 0, mask);
+    for (int i = 0; i < 0x80; i++) {
+        quint8 number = static_cast<quint8>(i);
+        if (hasKey(key + i) &&
+            ((key == KEY_NOTE) ? filter.isNoteAccepted(number) :
+             filter.isControllerAccepted(number))) {
+            addKeyBits(key + i, 0, mask);
+        }
+    }
+}
+
+bool
+MessageIndex::hasKey(int key) const
+{
+    return ! (bitmaps[key].isEmpty() && lists[key].isEmpty());
+}
+
+void
+MessageIndex::setBit(int key, int index)
+{
+    QVector<quint64> &bitmap = bitmaps[key];
+    if (bitmap.isEmpty()) {
+        QVector<quint16> &list = lists[key];
+        int capacity = list.capacity();
+        if ((list.count() + 1) * static_cast<int>(sizeof(quint16)) <
+            wordCount * static_cast<int>(sizeof(quint64))) {
+            list.append(static_cast<quint16>(index));
+            byteCount += (list.capacity() - capacity) *
+                static_cast<qint64>(sizeof(quint16));
+            return;
+        }
+
+        // The list would be as large as a bitmap, so it's replaced by one.
+        bitmap.fill(0, wordCount);
+        for (int i = list.count() - 1; i >= 0; i--) {
+            int listIndex = list[i];
+            bitmap[listIndex >> 6] |= Q_UINT64_C(1) << (listIndex & 0x3f);
+        }
+        list = QVector<quint16>();
+        byteCount += (wordCount * static_cast<qint64>(sizeof(quint64))) -
+            (capacity * static_cast<qint64>(sizeof(quint16)));
+    }
+    bitmap[index >> 6] |= Q_UINT64_C(1) << (index & 0x3f);
+}
@@ -0,0 +1,100 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __MESSAGEINDEX_H__
+#define __MESSAGEINDEX_H__
+
+#include <QtCore/QVector>
+
+#include "messagefilter.h"
+
+// Bitmap indexes over a fixed number of consecutive messages.  There's a
+// bitmap for each status byte (which includes the channel of channel
+// messages), each note number, each controller number, note and control
+// change messages without a usable data byte, and empty messages.
+//
+// Most keys are rare in a given run of messages, so a key starts out as a
+// sorted list of the indexes of its messages, and only becomes a bitmap once
+// the list would be as large as the bitmap.  Keys without messages take no
+// space at all.
+//
+// Finding the messages accepted by a `MessageFilter` combines the bitmaps
+// with AND and OR a word at a time, instead of looking at the messages, and
+// gives the same answer as `MessageFilter::accepts`.
+
+class MessageIndex {
+
+public:
+
+    explicit
+    MessageIndex(int size);
+
+    ~MessageIndex();
+
+    // Adds the message at `index`.  Messages must be added in order.
+    void
+    addMessage(int index, const quint8 *message, quint32 length);
+
+    // Appends the indexes of the messages accepted by `filter`, plus
+    // `offset`, to `indexes`.
+    void
+    findMessages(const MessageFilter &filter, qint64 offset,
+                 QVector<qint64> &indexes) const;
+
+    // Returns the number of bytes allocated for the index's bitmaps and
+    // lists.
+    qint64
+    getByteCount() const;
+
+private:
+
+    enum Key {
+        KEY_STATUS = 0,
+        KEY_NOTE = 0x100,
+        KEY_CONTROLLER = 0x180,
+        KEY_MISSING_NUMBER = 0x200,
+        KEY_EMPTY = 0x201,
+
+        KEY_TOTAL = 0x202
+    };
+
+    // ORs the bits of the messages with `key` into `bits`, leaving out the
+    // messages whose bits aren't set in `mask`, if a mask is given.
+    void
+    addKeyBits(int key, const QVector<quint64> *mask,
+               QVector<quint64> &bits) const;
+
+    void
+    getNumberMask(const MessageFilter &filter, int key,
+                  QVector<quint64> &mask) const;
+
+    bool
+    hasKey(int key) const;
+
+    void
+    setBit(int key, int index);
+
+    QVector<quint64> bitmaps[KEY_TOTAL];
+    qint64 byteCount;
+    QVector<quint16> lists[KEY_TOTAL];
+    int wordCount;
+
+};
+
+#endif
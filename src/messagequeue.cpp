@@ -0,0 +1,273 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThread>
+
+#include "messagequeue.h"
+
+// Static data
+
+// How long, in milliseconds, a producer waits for room before the event is
+// dropped.
+static const qint64 blockTimeout = 50;
+
+// Static functions
+
+quint32
+MessageQueue::getCapacity(quint32 size)
+{
+    assert((size > 0) && (size <= 0x80000000));
+    quint32 capacity = 1;
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+// Class definition
+
+MessageQueue::MessageQueue(quint32 recordCapacity, quint32 dataCapacity)
+{
+    this->dataCapacity = getCapacity(dataCapacity);
+    dataMask = this->dataCapacity - 1;
+    this->recordCapacity = getCapacity(recordCapacity);
+    recordMask = this->recordCapacity - 1;
+    data = new quint8[this->dataCapacity];
+    records = new Record[this->recordCapacity];
+    memoryLocked = false;
+    closed.store(0);
+    dataHead.store(0);
+    dataTail.store(0);
+    droppedCount.store(0);
+    overflowPolicy.store(OVERFLOWPOLICY_DROP_NEWEST);
+    producerWaiting.store(0);
+    recordHead.store(0);
+    recordTail.store(0);
+}
+
+MessageQueue::~MessageQueue()
+{
+    setMemoryLocked(false);
+    delete[] data;
+    delete[] records;
+}
+
+void
+MessageQueue::advanceDataTail(quint32 end)
+{
+    // Both ends may release data when events are dropped from the front of
+    // the queue, so the release position must never move backwards.
+    for (;;) {
+        quint32 tail = dataTail.loadAcquire();
+        if ((static_cast<qint32>(end - tail) <= 0) ||
+            dataTail.testAndSetOrdered(tail, end)) {
+            break;
+        }
+    }
+}
+
+void
+MessageQueue::close()
+{
+    closed.storeRelease(1);
+    if (producerWaiting.testAndSetOrdered(1, 0)) {
+        room.release();
+    }
+}
+
+const MidiEvent *
+MessageQueue::front() const
+{
+    quint32 tail = recordTail.loadAcquire();
+    if (recordHead.loadAcquire() == tail) {
+        return 0;
+    }
+    return &(records[tail & recordMask].event);
+}
+
+const quint8 *
+MessageQueue::getData(const MidiEvent &event) const
+{
+    return event.isInline() ? event.data : data + event.dataOffset;
+}
+
+quint32
+MessageQueue::getDroppedCount() const
+{
+    return droppedCount.load();
+}
+
+MessageQueue::OverflowPolicy
+MessageQueue::getOverflowPolicy() const
+{
+    return static_cast<OverflowPolicy>(overflowPolicy.load());
+}
+
+bool
+MessageQueue::isEmpty() const
+{
+    return recordHead.loadAcquire() == recordTail.loadAcquire();
+}
+
+bool
+MessageQueue::pop()
+{
+    quint32 tail = recordTail.loadAcquire();
+    assert(recordHead.loadAcquire() != tail);
+
+    // The producer only overwrites a record after moving the tail past it, so
+    // if the tail is still where it was, the record is intact.
+    quint32 end = records[tail & recordMask].dataEnd;
+    if (! recordTail.testAndSetOrdered(tail, tail + 1)) {
+        return false;
+    }
+    advanceDataTail(end);
+    if (producerWaiting.testAndSetOrdered(1, 0)) {
+        room.release();
+    }
+    return true;
+}
+
+bool
+MessageQueue::push(const MidiEvent &event, const quint8 *message)
+{
+    quint32 size = event.getDataSize();
+    bool inlined = size <= MidiEvent::INLINE_SIZE;
+
+    // Message data is always stored contiguously.  If a message doesn't fit
+    // between the write position and the end of the buffer, then the space at
+    // the end of the buffer is skipped.  Messages larger than half of the
+    // buffer are rejected, as they could never be stored once the write
+    // position passes the middle of the buffer.
+    quint32 start = dataHead.load();
+    quint32 offset = start & dataMask;
+    quint32 end = start;
+    if (! inlined) {
+        if (size > (dataCapacity / 2)) {
+            droppedCount.fetchAndAddRelaxed(1);
+            return false;
+        }
+        if (size > (dataCapacity - offset)) {
+            start += dataCapacity - offset;
+            offset = 0;
+        }
+        end = start + size;
+    }
+
+    // Make room for the event, if necessary.
+    QElapsedTimer blockTimer;
+    quint32 head = recordHead.load();
+    for (;;) {
+        quint32 tail = recordTail.loadAcquire();
+        if (((head - tail) < recordCapacity) &&
+            (inlined || ((end - dataTail.loadAcquire()) <= dataCapacity))) {
+            break;
+        }
+        switch (overflowPolicy.load()) {
+        case OVERFLOWPOLICY_DROP_OLDEST:
+            if (head == tail) {
+
+                // The consumer has taken every event, but hasn't released
+                // the data of the last one yet.
+                QThread::yieldCurrentThread();
+            } else if (recordTail.testAndSetOrdered(tail, tail + 1)) {
+                advanceDataTail(records[tail & recordMask].dataEnd);
+                droppedCount.fetchAndAddRelaxed(1);
+            }
+            continue;
+        case OVERFLOWPOLICY_BLOCK:
+            if (! closed.loadAcquire()) {
+
+                // The room is checked again after the flag is set, so that an
+                // event popped before the consumer could see the flag isn't
+                // missed.  The consumer clears the flag when it signals.
+                if (! blockTimer.isValid()) {
+                    blockTimer.start();
+                    producerWaiting.fetchAndStoreOrdered(1);
+                    continue;
+                }
+                qint64 remaining = blockTimeout - blockTimer.elapsed();
+                if (remaining > 0) {
+                    room.tryAcquire(1, static_cast<int>(remaining));
+                    producerWaiting.fetchAndStoreOrdered(1);
+                    continue;
+                }
+            }
+            producerWaiting.storeRelease(0);
+            droppedCount.fetchAndAddRelaxed(1);
+            return false;
+        default:
+            droppedCount.fetchAndAddRelaxed(1);
+            return false;
+        }
+    }
+    if (blockTimer.isValid()) {
+        producerWaiting.storeRelease(0);
+    }
+
+    Record &record = records[head & recordMask];
+    MidiEvent &queued = record.event;
+    queued = event;
+    if (inlined) {
+        std::memcpy(queued.data, message, size);
+        queued.dataOffset = 0;
+    } else {
+        std::memcpy(data + offset, message, size);
+        queued.dataOffset = offset;
+    }
+    record.dataEnd = end;
+    dataHead.store(end);
+    recordHead.storeRelease(head + 1);
+    return true;
+}
+
+RealTimeResult
+MessageQueue::setMemoryLocked(bool locked)
+{
+    if (locked == memoryLocked) {
+        return REALTIMERESULT_SUCCEEDED;
+    }
+    if (! locked) {
+        unlockMemory(data, dataCapacity);
+        unlockMemory(records, recordCapacity * sizeof(Record));
+        memoryLocked = false;
+        return REALTIMERESULT_SUCCEEDED;
+    }
+    RealTimeResult result = lockMemory(data, dataCapacity);
+    if (result != REALTIMERESULT_SUCCEEDED) {
+        return result;
+    }
+    result = lockMemory(records, recordCapacity * sizeof(Record));
+    if (result != REALTIMERESULT_SUCCEEDED) {
+        unlockMemory(data, dataCapacity);
+        return result;
+    }
+    memoryLocked = true;
+    return result;
+}
+
+void
+MessageQueue::setOverflowPolicy(OverflowPolicy policy)
+{
+    overflowPolicy.store(policy);
+}
@@ -0,0 +1,152 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __MESSAGEQUEUE_H__
+#define __MESSAGEQUEUE_H__
+
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QSemaphore>
+
+#include "midievent.h"
+#include "realtime.h"
+
+// A single-producer/single-consumer queue that carries MIDI messages from the
+// MIDI driver's callback thread to the GUI thread.  All storage is allocated
+// when the queue is constructed, so neither end allocates memory, and neither
+// end takes a lock unless the producer waits for room.  Capacities are
+// rounded up to powers of two.
+//
+// Events are stored as `MidiEvent` records.  The payloads of messages that
+// are too long to be stored inline are kept in a circular data buffer.
+//
+// The overflow policy decides what happens when the queue is full: the new
+// event can be dropped, the oldest queued events can be dropped to make room
+// for it, or the producer can wait for the consumer to make room.  A waiting
+// producer sleeps on a semaphore that `pop` signals, and gives up and drops
+// the event if no room is made within a short time, so it never spins
+// against a consumer it might be starving.  Dropped events are counted.
+
+class MessageQueue {
+
+public:
+
+    enum OverflowPolicy {
+        OVERFLOWPOLICY_DROP_NEWEST = 0,
+        OVERFLOWPOLICY_DROP_OLDEST = 1,
+        OVERFLOWPOLICY_BLOCK = 2
+    };
+
+    explicit
+    MessageQueue(quint32 recordCapacity=4096, quint32 dataCapacity=1048576);
+
+    ~MessageQueue();
+
+    quint32
+    getDroppedCount() const;
+
+    OverflowPolicy
+    getOverflowPolicy() const;
+
+    // Locks or unlocks the queue's storage in memory, so that the producer
+    // doesn't page fault.
+    RealTimeResult
+    setMemoryLocked(bool locked);
+
+    void
+    setOverflowPolicy(OverflowPolicy policy);
+
+    // Consumer interface
+
+    // Stops the producer from waiting for room in the queue.  Once the queue
+    // is closed, events that don't fit are dropped, whatever the overflow
+    // policy.
+    void
+    close();
+
+    const MidiEvent *
+    front() const;
+
+    const quint8 *
+    getData(const MidiEvent &event) const;
+
+    bool
+    isEmpty() const;
+
+    // Removes the front event.  Returns false if the producer dropped the
+    // event while the consumer was reading it, in which case whatever the
+    // consumer read must be discarded.
+    bool
+    pop();
+
+    // Producer interface
+
+    // Queues a copy of `event`, with its payload taken from `data`.  The
+    // event's `dataOffset` and inline data are filled in by the queue.
+    bool
+    push(const MidiEvent &event, const quint8 *data);
+
+private:
+
+    struct Record {
+        MidiEvent event;
+        quint32 dataEnd;
+    };
+
+    static quint32
+    getCapacity(quint32 size);
+
+    MessageQueue(const MessageQueue &);
+
+    MessageQueue &
+    operator=(const MessageQueue &);
+
+    void
+    advanceDataTail(quint32 end);
+
+    quint8 *data;
+    quint32 dataCapacity;
+    quint32 dataMask;
+    bool memoryLocked;
+    Record *records;
+    quint32 recordCapacity;
+    quint32 recordMask;
+
+    QAtomicInteger<int> closed;
+    QAtomicInteger<int> overflowPolicy;
+
+    // Released by the consumer when it pops an event while `producerWaiting`
+    // is set.
+    QSemaphore room;
+    QAtomicInteger<int> producerWaiting;
+
+    // The producer and consumer positions live on separate cache lines so the
+    // two threads don't fight over the same line.
+
+    char producerPadding[64];
+    QAtomicInteger<quint32> dataHead;
+    QAtomicInteger<quint32> droppedCount;
+    QAtomicInteger<quint32> recordHead;
+
+    char consumerPadding[64];
+    QAtomicInteger<quint32> dataTail;
+    QAtomicInteger<quint32> recordTail;
+
+};
+
+#endif
@@ -0,0 +1,797 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+
+#include <QtCore/QDateTime>
+#include <QtWidgets/QApplication>
+
+#include "messageformatter.h"
+#include "messagetablemodel.h"
+#include "umptranslator.h"
+
+// Static data
+
+// The number of rows whose text is kept.  It comfortably covers the rows
+// that fit on a screen.
+static const int formattedMessageCacheSize = 256;
+
+// What a row costs, apart from its message bytes and its share of its page's
+// index, when the byte limit is checked.
+static const qint64 rowOverhead = 32;
+
+// The most UMP words shown in a tooltip.
+static const int maximumToolTipWords = 16;
+
+// Every cell is aligned the same way.
+static const int textAlignment = Qt::AlignTop;
+
+// Class definition
+
+MessageTableModel::MessageTableModel(QObject *parent):
+    QAbstractTableModel(parent),
+    errorIcon(":/midisnoop/images/16x16/error.png"),
+    formattedMessages(formattedMessageCacheSize),
+    sentBrush(qApp->palette().alternateBase())
+{
+    byteCount = 0;
+    byteLimit = 0;
+    count = 0;
+    evictedRowCount = 0;
+    firstPageRow = 0;
+    rowLimit = 0;
+    startTime = 0;
+}
+
+MessageTableModel::~MessageTableModel()
+{
+    qDeleteAll(pages);
+}
+
+void
+MessageTableModel::addMessages(const QVector<Message> &messages)
+{
+    int added = messages.count();
+    if (added) {
+        beginInsertRows(QModelIndex(), count, count + added - 1);
+        MessageRef ref;
+        ref.spillOffset = 0;
+        for (int i = 0; i < added; i++) {
+            const Message &message = messages[i];
+            ref.annotation = message.annotation;
+            ref.data = reinterpret_cast<const quint8 *>
+                (message.data.constData());
+            ref.dataSize = static_cast<quint32>(message.data.size());
+            ref.length = message.length;
+            ref.port = getPortId(message.port);
+            ref.timeStamp = message.timeStamp;
+            ref.totalDropped = message.totalDropped;
+            ref.type = message.type;
+            appendMessage(ref);
+        }
+        endInsertRows();
+        evictMessages();
+    }
+}
+
+void
+MessageTableModel::addMessages(const QVector<MessageRef> &messages)
+{
+    int added = messages.count();
+    if (added) {
+        beginInsertRows(QModelIndex(), count, count + added - 1);
+        for (int i = 0; i < added; i++) {
+            appendMessage(messages[i]);
+        }
+        endInsertRows();
+        evictMessages();
+    }
+}
+
+void
+MessageTableModel::addPages(PageBuilder &builder)
+{
+    int added = builder.count;
+    if (! added) {
+        return;
+    }
+    QVector<quint16> builderPortIds(builder.portNames.count());
+    for (int i = 0; i < builderPortIds.count(); i++) {
+        builderPortIds[i] = getPortId(builder.portNames[i]);
+    }
+    beginInsertRows(QModelIndex(), count, count + added - 1);
+    int pageCount = builder.pages.count();
+    if ((firstPageRow + count) % PAGE_SIZE) {
+
+        // The new rows don't line up with the model's pages.
+        MessageRef message;
+        for (int i = 0; i < pageCount; i++) {
+            const Page &page = *(builder.pages[i]);
+            int rows = page.types.count();
+            for (int j = 0; j < rows; j++) {
+                quint32 start = j ? page.dataEnds[j - 1] : 0;
+                message.annotation.kind = page.annotationKinds[j];
+                message.annotation.number = page.annotationNumbers[j];
+                message.annotation.value = page.annotationValues[j];
+                message.data =
+                    reinterpret_cast<const quint8 *>(page.data.constData()) +
+                    start;
+                message.dataSize = page.dataEnds[j] - start;
+                message.length = page.lengths[j];
+                message.port = builderPortIds[page.ports[j]];
+                Spill spill = page.spills.value(j);
+                message.spillFile = spill.file;
+                message.spillOffset = spill.offset;
+                message.timeStamp = page.timeStamps[j];
+                message.totalDropped = page.totalDroppedCounts.value(j);
+                message.type = static_cast<MessageType>(page.types[j]);
+                appendMessage(message);
+            }
+        }
+        qDeleteAll(builder.pages);
+    } else {
+        for (int i = 0; i < pageCount; i++) {
+            QVector<quint16> &ports = builder.pages[i]->ports;
+            for (int j = ports.count() - 1; j >= 0; j--) {
+                ports[j] = builderPortIds[ports[j]];
+            }
+        }
+        if (! startTime) {
+            startTime = builder.pages.first()->timeStamps.first();
+        }
+        pages += builder.pages;
+        byteCount += builder.byteCount;
+        count += added;
+    }
+    builder.pages.clear();
+    builder.byteCount = 0;
+    builder.count = 0;
+    endInsertRows();
+    evictMessages();
+}
+
+void
+MessageTableModel::appendMessage(const MessageRef &message)
+{
+    assert(message.port < portNames.count());
+    if (! ((firstPageRow + count) % PAGE_SIZE)) {
+        pages.append(createPage());
+    }
+    if (! startTime) {
+        startTime = message.timeStamp;
+    }
+    byteCount += appendToPage(*(pages.last()), message);
+    count++;
+}
+
+qint64
+MessageTableModel::appendToPage(Page &page, const MessageRef &message)
+{
+    int pageRow = page.types.count();
+    qint64 indexByteCount = page.index->getByteCount();
+    assert(pageRow < PAGE_SIZE);
+    page.annotationKinds.append(message.annotation.kind);
+    page.annotationNumbers.append(message.annotation.number);
+    page.annotationValues.append(message.annotation.value);
+    page.data.append(reinterpret_cast<const char *>(message.data),
+                     static_cast<int>(message.dataSize));
+    page.dataEnds.append(static_cast<quint32>(page.data.size()));
+    page.index->addMessage(pageRow, message.data, message.dataSize);
+    page.lengths.append(message.length);
+    page.ports.append(message.port);
+    if (message.spillFile) {
+        Spill spill;
+        spill.file = message.spillFile;
+        spill.offset = message.spillOffset;
+        page.spills.insert(pageRow, spill);
+    }
+    page.timeStamps.append(message.timeStamp);
+    if (message.type == MESSAGETYPE_DROPPED) {
+        page.totalDroppedCounts.insert(pageRow, message.totalDropped);
+    }
+    page.types.append(static_cast<quint8>(message.type));
+    return message.dataSize + rowOverhead +
+        (page.index->getByteCount() - indexByteCount);
+}
+
+void
+MessageTableModel::clear()
+{
+    beginResetModel();
+    formattedMessages.clear();
+    for (int i = pages.count() - 1; i >= 0; i--) {
+        releaseSpills(*(pages[i]));
+    }
+    qDeleteAll(pages);
+    pages.clear();
+    byteCount = 0;
+    count = 0;
+    evictedRowCount = 0;
+    firstPageRow = 0;
+    startTime = 0;
+    endResetModel();
+}
+
+int
+MessageTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : COLUMN_TOTAL;
+}
+
+MessageTableModel::Page *
+MessageTableModel::createPage()
+{
+    Page *page = new Page();
+    page->annotationKinds.reserve(PAGE_SIZE);
+    page->annotationNumbers.reserve(PAGE_SIZE);
+    page->annotationValues.reserve(PAGE_SIZE);
+    page->dataEnds.reserve(PAGE_SIZE);
+    page->lengths.reserve(PAGE_SIZE);
+    page->ports.reserve(PAGE_SIZE);
+    page->timeStamps.reserve(PAGE_SIZE);
+    page->types.reserve(PAGE_SIZE);
+    return page;
+}
+
+QVariant
+MessageTableModel::data(const QModelIndex &index, int role) const
+{
+    if (! index.isValid()) {
+        return QVariant();
+    }
+    int row = index.row();
+    assert((row >= 0) && (row < count));
+    int pageRow;
+    const Page &page = getPage(row, pageRow);
+    int column = index.column();
+    switch (role) {
+    case Qt::BackgroundRole:
+        if (page.types[pageRow] == MESSAGETYPE_SENT) {
+            return sentBrush;
+        }
+        break;
+    case Qt::DecorationRole:
+        if ((column == COLUMN_STATUS) && (! getFormattedMessage(row).valid)) {
+            return errorIcon;
+        }
+        break;
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        switch (column) {
+        case COLUMN_DATA:
+
+            // The editor, which lets the text be selected and copied, always
+            // gets the whole of a spilled message.
+            if ((role == Qt::EditRole) &&
+                (page.types[pageRow] == MESSAGETYPE_SPILLED) &&
+                (! page.expandedRows.contains(pageRow))) {
+                FormattedMessage formatted;
+                formatMessage(row, true, formatted);
+                return formatted.dataDescription;
+            }
+            return getFormattedMessage(row).dataDescription;
+        case COLUMN_PORT:
+            return portNames[page.ports[pageRow]];
+        case COLUMN_STATUS:
+            return getFormattedMessage(row).statusDescription;
+        case COLUMN_TIMESTAMP:
+            return MessageFormatter::
+                getTimeString(static_cast<qint64>(page.timeStamps[pageRow] -
+                                                  startTime));
+        default:
+            assert(false);
+        }
+        break;
+    case Qt::TextAlignmentRole:
+        return textAlignment;
+    case Qt::ToolTipRole:
+        if (column == COLUMN_TIMESTAMP) {
+            return getTimeToolTip(page.timeStamps[pageRow]);
+        }
+        if (((column == COLUMN_DATA) || (column == COLUMN_STATUS)) &&
+            ((page.types[pageRow] == MESSAGETYPE_RECEIVED) ||
+             (page.types[pageRow] == MESSAGETYPE_SENT))) {
+            return getUMPToolTip(row);
+        }
+        break;
+    default:
+        ;
+    }
+    return QVariant();
+}
+
+void
+MessageTableModel::evictMessages()
+{
+    // Rows are evicted from the front one at a time, so both limits are kept
+    // exactly.  A page is dropped once all of its rows are evicted; until
+    // then, `firstPageRow` skips the rows that were evicted from it.
+    int evicted = 0;
+    qint64 evictedBytes = 0;
+    int pageIndex = 0;
+    int pageRow = firstPageRow;
+    while ((evicted < count) &&
+           (((rowLimit > 0) && ((count - evicted) > rowLimit)) ||
+            ((byteLimit > 0) && ((byteCount - evictedBytes) > byteLimit)))) {
+        const Page &page = *(pages[pageIndex]);
+        quint32 start = pageRow ? page.dataEnds[pageRow - 1] : 0;
+        evictedBytes += (page.dataEnds[pageRow] - start) + rowOverhead;
+
+        // Payloads are released in the order they were written, as in
+        // `releaseSpills`.
+        QHash<int, Spill>::const_iterator i = page.spills.constFind(pageRow);
+        if (i != page.spills.constEnd()) {
+            i.value().file->release(i.value().offset + page.lengths[pageRow]);
+        }
+
+        // A page's index is freed with the page.
+        evicted++;
+        if (++pageRow == PAGE_SIZE) {
+            evictedBytes += page.index->getByteCount();
+            pageIndex++;
+            pageRow = 0;
+        }
+    }
+    if (! evicted) {
+        return;
+    }
+    beginRemoveRows(QModelIndex(), 0, evicted - 1);
+    if (evicted == count) {
+        evictedBytes = byteCount;
+        pageIndex = pages.count();
+        pageRow = 0;
+    }
+    for (int i = 0; i < pageIndex; i++) {
+        Page *page = pages.takeFirst();
+        releaseSpills(*page);
+        delete page;
+    }
+    byteCount -= evictedBytes;
+    count -= evicted;
+    evictedRowCount += evicted;
+    firstPageRow = pageRow;
+
+    // The cache is keyed by the number of rows before a row since the model
+    // was cleared, so the cached text of the remaining rows is still found.
+    // The text of evicted rows is never asked for again, and ages out of the
+    // cache.
+    endRemoveRows();
+}
+
+Qt::ItemFlags
+MessageTableModel::flags(const QModelIndex &index) const
+{
+    // Cells are 'editable' so that the message table delegate can provide a
+    // read-only editor that allows the text to be selected and copied.
+    return QAbstractTableModel::flags(index) | Qt::ItemIsEditable;
+}
+
+void
+MessageTableModel::formatMessage(int row, bool whole,
+                                 FormattedMessage &formatted) const
+{
+    int pageRow;
+    const Page &page = getPage(row, pageRow);
+    quint32 length;
+    const quint8 *data = getData(row, length);
+    int type = page.types[pageRow];
+    QByteArray spilled;
+    if (whole && (type == MESSAGETYPE_SPILLED)) {
+        spilled = getSpilledData(row);
+        if (! spilled.isEmpty()) {
+            data = reinterpret_cast<const quint8 *>(spilled.constData());
+            length = static_cast<quint32>(spilled.size());
+            type = MESSAGETYPE_RECEIVED;
+        }
+    }
+    DecodedMessage decoded;
+    switch (type) {
+    case MESSAGETYPE_DROPPED:
+        formatted.dataDescription = tr("%1 messages dropped (%2 in total)").
+            arg(page.lengths[pageRow]).
+            arg(page.totalDroppedCounts.value(pageRow));
+        formatted.statusDescription = tr("Dropped Messages");
+        formatted.valid = false;
+        break;
+    case MESSAGETYPE_SPILLED:
+        // The preview of a spilled message holds the start of the message and
+        // its last byte, so it can be validated as a (shortened) message of
+        // its own.
+        decoded = decodeMessage(data, length);
+        formatted.dataDescription =
+            tr("%1 ... (%2 bytes, spilled to disk)").
+            arg(MessageFormatter::getHexString(data + 1,
+                                               static_cast<int>(length) - 2)).
+            arg(page.lengths[pageRow] - 2);
+        formatted.statusDescription =
+            MessageFormatter::getStatusDescription(decoded);
+        formatted.valid = decoded.isValid();
+        break;
+    default:
+        decoded = decodeMessage(data, length);
+        formatted.dataDescription =
+            MessageFormatter::getDataDescription(decoded, data);
+        if (page.annotationKinds[pageRow] != Annotation::KIND_NONE) {
+            Annotation annotation;
+            annotation.kind = page.annotationKinds[pageRow];
+            annotation.number = page.annotationNumbers[pageRow];
+            annotation.value = page.annotationValues[pageRow];
+            formatted.dataDescription = tr("%1 [%2]").
+                arg(formatted.dataDescription,
+                    MessageFormatter::getAnnotationDescription(annotation));
+        }
+        formatted.statusDescription =
+            MessageFormatter::getStatusDescription(decoded);
+        formatted.valid = decoded.isValid();
+    }
+}
+
+qint64
+MessageTableModel::getByteLimit() const
+{
+    return byteLimit;
+}
+
+const quint8 *
+MessageTableModel::getData(int row, quint32 &size) const
+{
+    int pageRow;
+    const Page &page = getPage(row, pageRow);
+    quint32 start = pageRow ? page.dataEnds[pageRow - 1] : 0;
+    size = page.dataEnds[pageRow] - start;
+    return reinterpret_cast<const quint8 *>(page.data.constData()) + start;
+}
+
+const MessageTableModel::FormattedMessage &
+MessageTableModel::getFormattedMessage(int row) const
+{
+    qint64 key = evictedRowCount + row;
+    FormattedMessage *formatted = formattedMessages.object(key);
+    if (formatted) {
+        return *formatted;
+    }
+    formatted = new FormattedMessage();
+    int pageRow;
+    const Page &page = getPage(row, pageRow);
+    formatMessage(row, page.expandedRows.contains(pageRow), *formatted);
+    bool inserted = formattedMessages.insert(key, formatted);
+    assert(inserted);
+    return *formatted;
+}
+
+QList<QSharedPointer<const MessageIndex> >
+MessageTableModel::getFullPageIndexes(int &firstRow) const
+{
+    QList<QSharedPointer<const MessageIndex> > indexes;
+    firstRow = -firstPageRow;
+    int pageCount = (firstPageRow + count) / PAGE_SIZE;
+    for (int i = 0; i < pageCount; i++) {
+        indexes.append(pages[i]->index);
+    }
+    return indexes;
+}
+
+MessageTableModel::Message
+MessageTableModel::getMessage(int row) const
+{
+    assert((row >= 0) && (row < count));
+    int pageRow;
+    const Page &page = getPage(row, pageRow);
+    quint32 size;
+    const quint8 *data = getData(row, size);
+    Message message;
+    message.annotation.kind = page.annotationKinds[pageRow];
+    message.annotation.number = page.annotationNumbers[pageRow];
+    message.annotation.value = page.annotationValues[pageRow];
+    message.data = QByteArray(reinterpret_cast<const char *>(data),
+                              static_cast<int>(size));
+    message.length = page.lengths[pageRow];
+    message.port = portNames[page.ports[pageRow]];
+    message.timeStamp = page.timeStamps[pageRow];
+    message.totalDropped = page.totalDroppedCounts.value(pageRow);
+    message.type = static_cast<MessageType>(page.types[pageRow]);
+    if (message.type == MESSAGETYPE_SPILLED) {
+        QByteArray spilled = getSpilledData(row);
+        if (! spilled.isEmpty()) {
+            message.data = spilled;
+            message.type = MESSAGETYPE_RECEIVED;
+        }
+    }
+    return message;
+}
+
+const MessageTableModel::Page &
+MessageTableModel::getPage(int row, int &pageRow) const
+{
+    int position = row + firstPageRow;
+    pageRow = position % PAGE_SIZE;
+    return *(pages[position / PAGE_SIZE]);
+}
+
+MessageTableModel::Page &
+MessageTableModel::getPage(int row, int &pageRow)
+{
+    int position = row + firstPageRow;
+    pageRow = position % PAGE_SIZE;
+    return *(pages[position / PAGE_SIZE]);
+}
+
+qint64
+MessageTableModel::getPageByteCount(const Page &page)
+{
+    return page.data.size() + (page.types.count() * rowOverhead) +
+        page.index->getByteCount();
+}
+
+quint16
+MessageTableModel::getPortId(const QString &port)
+{
+    QHash<QString, quint16>::const_iterator i = portIds.constFind(port);
+    if (i != portIds.constEnd()) {
+        return i.value();
+    }
+    quint16 id = static_cast<quint16>(portNames.count());
+    portIds.insert(port, id);
+    portNames.append(port);
+    return id;
+}
+
+int
+MessageTableModel::getRowLimit() const
+{
+    return rowLimit;
+}
+
+QByteArray
+MessageTableModel::getSpilledData(int row) const
+{
+    int pageRow;
+    const Page &page = getPage(row, pageRow);
+    QByteArray data;
+    QHash<int, Spill>::const_iterator i = page.spills.constFind(pageRow);
+    if (i != page.spills.constEnd()) {
+        const Spill &spill = i.value();
+        quint32 length = page.lengths[pageRow];
+        data.resize(static_cast<int>(length));
+        if (! spill.file->read(spill.offset, length,
+                               reinterpret_cast<quint8 *>(data.data()))) {
+            data.clear();
+        }
+    }
+    return data;
+}
+
+QString
+MessageTableModel::getTimeToolTip(quint64 timeStamp) const
+{
+    // Times are shown relative to the first message, and the tooltip shows
+    // the wall clock time the message was sent or received at.
+    QDateTime time =
+        QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(timeStamp / 1000));
+    return tr("%1.%2").arg(time.toString("yyyy-MM-dd hh:mm:ss")).
+        arg(timeStamp % 1000000, 6, 10, QChar('0'));
+}
+
+QString
+MessageTableModel::getUMPToolTip(int row) const
+{
+    // Messages are also shown as the Universal MIDI Packets they translate
+    // to, and channel voice messages as their MIDI 2.0 equivalents.
+    quint32 length;
+    const quint8 *data = getData(row, length);
+    QVector<quint32> words;
+    if (! translateToUMP(data, length, 0, words)) {
+        return QString();
+    }
+    int wordCount = words.count();
+    QString toolTip =
+        MessageFormatter::getUMPHexString(words.constData(),
+                                          qMin(wordCount,
+                                               maximumToolTipWords));
+    if (wordCount > maximumToolTipWords) {
+        toolTip = tr("%1 ...").arg(toolTip);
+    }
+    toolTip = tr("UMP: %1").arg(toolTip);
+    quint32 midi2Words[2];
+    if (translateToMIDI2(words[0], midi2Words)) {
+        toolTip = tr("%1\nMIDI 2.0: %2\n%3").
+            arg(toolTip, MessageFormatter::getUMPHexString(midi2Words, 2),
+                MessageFormatter::getUMPDescription
+                (decodeUMPMessage(midi2Words, 2)));
+    }
+    return toolTip;
+}
+
+QVariant
+MessageTableModel::headerData(int section, Qt::Orientation orientation,
+                              int role) const
+{
+    if ((orientation == Qt::Horizontal) && (role == Qt::DisplayRole)) {
+        switch (section) {
+        case COLUMN_DATA:
+            return tr("Data");
+        case COLUMN_PORT:
+            return tr("Port");
+        case COLUMN_STATUS:
+            return tr("Status");
+        case COLUMN_TIMESTAMP:
+            return tr("Time (s)");
+        default:
+            ;
+        }
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+bool
+MessageTableModel::isMessageAccepted(int row,
+                                     const MessageFilter &filter) const
+{
+    assert((row >= 0) && (row < count));
+    quint32 size;
+    const quint8 *data = getData(row, size);
+    return filter.accepts(data, size);
+}
+
+bool
+MessageTableModel::isMessageExpanded(int row) const
+{
+    assert((row >= 0) && (row < count));
+    int pageRow;
+    const Page &page = getPage(row, pageRow);
+    return page.expandedRows.contains(pageRow);
+}
+
+void
+MessageTableModel::releaseSpills(const Page &page)
+{
+    // Payloads are written to a spill file in the order their messages are
+    // received, and rows are dropped in the same order, so releasing a
+    // payload releases every payload before it as well.
+    QHash<int, Spill>::const_iterator i;
+    for (i = page.spills.constBegin(); i != page.spills.constEnd(); i++) {
+        const Spill &spill = i.value();
+        spill.file->release(spill.offset + page.lengths[i.key()]);
+    }
+}
+
+void
+MessageTableModel::retranslate()
+{
+    formattedMessages.clear();
+    emit headerDataChanged(Qt::Horizontal, 0, COLUMN_TOTAL - 1);
+    if (count) {
+        emit dataChanged(index(0, 0), index(count - 1, COLUMN_TOTAL - 1));
+    }
+}
+
+int
+MessageTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : count;
+}
+
+void
+MessageTableModel::setByteLimit(qint64 limit)
+{
+    assert(limit >= 0);
+    byteLimit = limit;
+    evictMessages();
+}
+
+void
+MessageTableModel::setMessageExpanded(int row, bool expanded)
+{
+    assert((row >= 0) && (row < count));
+    int pageRow;
+    Page &page = getPage(row, pageRow);
+    if ((page.types[pageRow] != MESSAGETYPE_SPILLED) ||
+        (page.expandedRows.contains(pageRow) == expanded)) {
+        return;
+    }
+    if (expanded) {
+        page.expandedRows.insert(pageRow);
+    } else {
+        page.expandedRows.remove(pageRow);
+    }
+    formattedMessages.remove(evictedRowCount + row);
+    emit dataChanged(index(row, 0), index(row, COLUMN_TOTAL - 1));
+}
+
+void
+MessageTableModel::setRowLimit(int limit)
+{
+    assert(limit >= 0);
+    rowLimit = limit;
+    evictMessages();
+}
+
+// Page builder class definition
+
+MessageTableModel::PageBuilder::PageBuilder()
+{
+    byteCount = 0;
+    count = 0;
+    page = 0;
+}
+
+MessageTableModel::PageBuilder::~PageBuilder()
+{
+    clear();
+}
+
+void
+MessageTableModel::PageBuilder::addMessage(const MessageRef &message)
+{
+    assert(message.port < portNames.count());
+    if (! page) {
+        page = createPage();
+    }
+    appendToPage(*page, message);
+    if (page->types.count() == PAGE_SIZE) {
+        finish();
+    }
+}
+
+void
+MessageTableModel::PageBuilder::clear()
+{
+    qDeleteAll(pages);
+    pages.clear();
+    delete page;
+    page = 0;
+    byteCount = 0;
+    count = 0;
+}
+
+void
+MessageTableModel::PageBuilder::finish()
+{
+    if (page) {
+        byteCount += getPageByteCount(*page);
+        count += page->types.count();
+        pages.append(page);
+        page = 0;
+    }
+}
+
+int
+MessageTableModel::PageBuilder::getRowCount() const
+{
+    return count;
+}
+
+void
+MessageTableModel::PageBuilder::setPortNames(const QStringList &portNames)
+{
+    this->portNames = portNames;
+}
+
+void
+MessageTableModel::PageBuilder::takePages(PageBuilder &builder)
+{
+    assert(! page);
+    pages += builder.pages;
+    byteCount += builder.byteCount;
+    count += builder.count;
+    portNames = builder.portNames;
+    builder.pages.clear();
+    builder.byteCount = 0;
+    builder.count = 0;
+}
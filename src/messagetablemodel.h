@@ -0,0 +1,376 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __MESSAGETABLEMODEL_H__
+#define __MESSAGETABLEMODEL_H__
+
+#include <QtCore/QAbstractTableModel>
+#include <QtCore/QByteArray>
+#include <QtCore/QCache>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+#include <QtGui/QBrush>
+#include <QtGui/QIcon>
+
+#include "messageannotator.h"
+#include "messagefilter.h"
+#include "messageindex.h"
+#include "spillfile.h"
+
+// The model behind the message list.  Only the raw bytes of each message are
+// kept.  The text shown in the status and data columns is produced when a
+// view asks for it, and a small cache keeps the text of recently displayed
+// rows, so that the cost of formatting depends on what's on screen instead
+// of on how many messages have been captured.  Times are shown in seconds
+// since the first message added after the model was last cleared.
+//
+// Messages are stored in pages of `PAGE_SIZE` rows.  Each page keeps its
+// fields in arrays of their own, its message bytes packed into a single
+// buffer, and port names as indexes into a shared table, so a row takes
+// about 26 bytes plus the bytes of its message, and a few more for the
+// index described below.
+//
+// The model can be limited to a number of rows, a number of bytes, or both.
+// When a limit is exceeded, the oldest rows are evicted one at a time until
+// the model is within its limits again, so the limits are kept exactly.  A
+// page is freed once all of its rows have been evicted.  A limit of 0 means
+// there's no limit.  The payloads of evicted spilled messages are released
+// from their spill files.
+//
+// Each page also keeps a `MessageIndex` of its messages, which is updated as
+// messages are added, so the rows accepted by a filter can be found without
+// looking at every message.  The index of a full page never changes again,
+// and is shared, so it can be searched on another thread even after the
+// page is evicted.  The byte limit counts each page's index along with its
+// rows, and an index's bytes are freed when its page is.
+
+class MessageTableModel: public QAbstractTableModel {
+
+    Q_OBJECT
+
+public:
+
+    static const int PAGE_SIZE = 4096;
+
+    enum Column {
+        COLUMN_TIMESTAMP = 0,
+        COLUMN_PORT = 1,
+        COLUMN_STATUS = 2,
+        COLUMN_DATA = 3,
+
+        COLUMN_TOTAL = 4
+    };
+
+    enum MessageType {
+        MESSAGETYPE_RECEIVED = 0,
+        MESSAGETYPE_SENT = 1,
+
+        // `data` holds the preview of a message that was spilled to disk
+        // (see `MidiEvent`), and `length` is the length of the whole message.
+        // The whole message is read back from the spill file when it's
+        // needed, for as long as the row is kept.
+        MESSAGETYPE_SPILLED = 2,
+
+        // `length` is the number of messages that were dropped, and
+        // `totalDropped` is the number of messages dropped from the port so
+        // far.  `data` is empty.
+        MESSAGETYPE_DROPPED = 3
+    };
+
+    // `annotation` is only used by received messages.
+    struct Message {
+        Annotation annotation;
+        QByteArray data;
+        quint32 length;
+        QString port;
+        quint64 timeStamp;
+        quint32 totalDropped;
+        MessageType type;
+    };
+
+    // A message that's added without being copied first.  `data` points at
+    // the `dataSize` bytes that are kept for the message (see `Message`),
+    // and only has to stay valid until the message is added.  `port` is an
+    // id returned by `getPortId`.  Spilled messages also give the spill file
+    // their payload was written to, and its offset in the file.
+    struct MessageRef {
+        Annotation annotation;
+        const quint8 *data;
+        quint32 dataSize;
+        quint32 length;
+        quint16 port;
+        QSharedPointer<SpillFile> spillFile;
+        quint64 spillOffset;
+        quint64 timeStamp;
+        quint32 totalDropped;
+        MessageType type;
+    };
+
+    class PageBuilder;
+
+    explicit
+    MessageTableModel(QObject *parent=0);
+
+    ~MessageTableModel();
+
+    void
+    addMessages(const QVector<Message> &messages);
+
+    void
+    addMessages(const QVector<MessageRef> &messages);
+
+    // Takes the pages that `builder` can hand over.  The pages are linked in
+    // when the model's last page is full; otherwise, their rows are copied.
+    void
+    addPages(PageBuilder &builder);
+
+    void
+    clear();
+
+    int
+    columnCount(const QModelIndex &parent=QModelIndex()) const;
+
+    QVariant
+    data(const QModelIndex &index, int role=Qt::DisplayRole) const;
+
+    Qt::ItemFlags
+    flags(const QModelIndex &index) const;
+
+    qint64
+    getByteLimit() const;
+
+    // Returns the indexes of the pages that are full.  The first index
+    // covers rows `firstRow` to `firstRow + PAGE_SIZE - 1`, and so on.
+    // `firstRow` is negative when rows have been evicted from the first page
+    // without the page being dropped.
+    QList<QSharedPointer<const MessageIndex> >
+    getFullPageIndexes(int &firstRow) const;
+
+    // Spilled messages are read back from their spill file, and returned as
+    // received messages, if they can be.
+    Message
+    getMessage(int row) const;
+
+    // Returns the id of the named port, which stays the same even when the
+    // model is cleared.
+    quint16
+    getPortId(const QString &port);
+
+    int
+    getRowLimit() const;
+
+    QVariant
+    headerData(int section, Qt::Orientation orientation,
+               int role=Qt::DisplayRole) const;
+
+    bool
+    isMessageAccepted(int row, const MessageFilter &filter) const;
+
+    bool
+    isMessageExpanded(int row) const;
+
+    // Drops the text that's been formatted for the rows and the headers, so
+    // that it's formatted again with the current translators and locale.
+    void
+    retranslate();
+
+    int
+    rowCount(const QModelIndex &parent=QModelIndex()) const;
+
+    void
+    setByteLimit(qint64 limit);
+
+    // Expanded rows show the whole of a spilled message, instead of its
+    // preview.
+    void
+    setMessageExpanded(int row, bool expanded);
+
+    void
+    setRowLimit(int limit);
+
+private:
+
+    struct FormattedMessage {
+        QString dataDescription;
+        QString statusDescription;
+        bool valid;
+    };
+
+    struct Spill {
+        QSharedPointer<SpillFile> file;
+        quint64 offset;
+    };
+
+    // `dataEnds` holds the offset in `data` just past each row's bytes.
+    // Only dropped message rows have a total dropped count, and only spilled
+    // message rows have a spill.
+    struct Page {
+
+        Page():
+            index(new MessageIndex(PAGE_SIZE))
+        {
+            // Empty
+        }
+
+        QVector<quint8> annotationKinds;
+        QVector<quint16> annotationNumbers;
+        QVector<quint32> annotationValues;
+        QByteArray data;
+        QVector<quint32> dataEnds;
+        QSet<int> expandedRows;
+        QSharedPointer<MessageIndex> index;
+        QVector<quint32> lengths;
+        QVector<quint16> ports;
+        QHash<int, Spill> spills;
+        QVector<quint64> timeStamps;
+        QHash<int, quint32> totalDroppedCounts;
+        QVector<quint8> types;
+
+    };
+
+    // Returns the number of bytes the message adds to the page.
+    static qint64
+    appendToPage(Page &page, const MessageRef &message);
+
+    static Page *
+    createPage();
+
+    static qint64
+    getPageByteCount(const Page &page);
+
+    void
+    appendMessage(const MessageRef &message);
+
+    void
+    evictMessages();
+
+    // Formats a row's message.  If `whole` is set, a spilled message is read
+    // back from its spill file and formatted in full.
+    void
+    formatMessage(int row, bool whole, FormattedMessage &formatted) const;
+
+    const quint8 *
+    getData(int row, quint32 &size) const;
+
+    const FormattedMessage &
+    getFormattedMessage(int row) const;
+
+    // Returns the page that holds `row`, and sets `pageRow` to the row's
+    // index in the page.
+    const Page &
+    getPage(int row, int &pageRow) const;
+
+    Page &
+    getPage(int row, int &pageRow);
+
+    // Returns the whole of a spilled message, or an empty array if it can't
+    // be read.
+    QByteArray
+    getSpilledData(int row) const;
+
+    QString
+    getTimeToolTip(quint64 timeStamp) const;
+
+    QString
+    getUMPToolTip(int row) const;
+
+    void
+    releaseSpills(const Page &page);
+
+    qint64 byteCount;
+    qint64 byteLimit;
+    int count;
+    QIcon errorIcon;
+
+    // The number of rows that have been evicted since the model was cleared.
+    qint64 evictedRowCount;
+
+    // The number of rows that have been evicted from the first page.
+    int firstPageRow;
+
+    // Keyed by `evictedRowCount` plus the row.
+    mutable QCache<qint64, FormattedMessage> formattedMessages;
+    QList<Page *> pages;
+    QHash<QString, quint16> portIds;
+    QStringList portNames;
+    int rowLimit;
+    QBrush sentBrush;
+    quint64 startTime;
+
+};
+
+// Builds pages of rows away from the GUI thread, so that adding the rows to a
+// model only has to link the pages in (see `MessageTableModel::addPages`).
+// The ports of the messages that are added are indexes into the builder's
+// port names, and are mapped to the model's port ids when the pages are
+// added.  A builder can only be used by one thread at a time.
+
+class MessageTableModel::PageBuilder {
+
+public:
+
+    PageBuilder();
+
+    ~PageBuilder();
+
+    void
+    addMessage(const MessageRef &message);
+
+    // Discards the builder's pages.
+    void
+    clear();
+
+    // Lets the last page be handed over, even though it isn't full.
+    void
+    finish();
+
+    // Returns the number of rows in the pages that can be handed over.
+    int
+    getRowCount() const;
+
+    void
+    setPortNames(const QStringList &portNames);
+
+    // Moves the pages that can be handed over, and the port names, from
+    // `builder` to this builder.
+    void
+    takePages(PageBuilder &builder);
+
+private:
+
+    friend class MessageTableModel;
+
+    PageBuilder(const PageBuilder &);
+
+    PageBuilder &
+    operator=(const PageBuilder &);
+
+    qint64 byteCount;
+    int count;
+    Page *page;
+    QList<Page *> pages;
+    QStringList portNames;
+
+};
+
+#endif
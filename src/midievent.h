@@ -0,0 +1,71 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __MIDIEVENT_H__
+#define __MIDIEVENT_H__
+
+#include <QtCore/QtGlobal>
+
+// A compact, fixed-size MIDI event.  Messages of up to three bytes (every
+// channel message and every system common and real-time message) are stored
+// inline.  Longer messages (system exclusive messages, and malformed
+// messages) are stored in an arena owned by the container that holds the
+// event, and `dataOffset` locates them in that arena.
+//
+// The payloads of very large messages are written to a spill file instead.
+// For those messages, the arena holds a preview of the message (its first
+// `PREVIEW_SIZE - 1` bytes, followed by its last byte), followed by the
+// message's offset in the spill file.
+//
+// `sequence` numbers the messages received on a port, so that gaps left by
+// dropped messages can be detected.
+
+struct MidiEvent {
+
+    enum Flag {
+        FLAG_SPILLED = 0x1
+    };
+
+    static const quint32 INLINE_SIZE = 3;
+    static const quint32 PREVIEW_SIZE = 64;
+    static const quint32 SPILLED_DATA_SIZE = PREVIEW_SIZE + sizeof(quint64);
+
+    quint32
+    getDataSize() const
+    {
+        return (flags & FLAG_SPILLED) ? SPILLED_DATA_SIZE : length;
+    }
+
+    bool
+    isInline() const
+    {
+        return getDataSize() <= INLINE_SIZE;
+    }
+
+    quint64 timeStamp;
+    quint32 dataOffset;
+    quint32 length;
+    quint32 sequence;
+    quint16 port;
+    quint8 data[INLINE_SIZE];
+    quint8 flags;
+
+};
+
+#endif
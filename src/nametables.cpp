@@ -0,0 +1,309 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QLocale>
+
+#include "nametables.h"
+
+// Static data
+
+struct ControlName {
+    quint8 control;
+    const char *name;
+};
+
+struct NoteName {
+    const char *context;
+    const char *name;
+};
+
+// Controllers that aren't listed are undefined.
+static const ControlName controlNames[] = {
+    {0x00, QT_TRANSLATE_NOOP("QApplication", "Bank Select")},
+    {0x01, QT_TRANSLATE_NOOP("QApplication", "Modulation Wheel")},
+    {0x02, QT_TRANSLATE_NOOP("QApplication", "Breath Controller")},
+    {0x04, QT_TRANSLATE_NOOP("QApplication", "Foot Controller")},
+    {0x05, QT_TRANSLATE_NOOP("QApplication", "Portamento Time")},
+    {0x06, QT_TRANSLATE_NOOP("QApplication", "Data Entry MSB")},
+    {0x07, QT_TRANSLATE_NOOP("QApplication", "Channel Volume")},
+    {0x08, QT_TRANSLATE_NOOP("QApplication", "Balance")},
+    {0x0a, QT_TRANSLATE_NOOP("QApplication", "Pan")},
+    {0x0b, QT_TRANSLATE_NOOP("QApplication", "Expression Controller")},
+    {0x0c, QT_TRANSLATE_NOOP("QApplication", "Effect Control 1")},
+    {0x0d, QT_TRANSLATE_NOOP("QApplication", "Effect Control 2")},
+    {0x10,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "General Purpose Controller 1")},
+    {0x11,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "General Purpose Controller 2")},
+    {0x12,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "General Purpose Controller 3")},
+    {0x13,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "General Purpose Controller 4")},
+    {0x20, QT_TRANSLATE_NOOP("QApplication", "Bank Select LSB")},
+    {0x21, QT_TRANSLATE_NOOP("QApplication", "Modulation Wheel LSB")},
+    {0x22, QT_TRANSLATE_NOOP("QApplication", "Breath Controller LSB")},
+    {0x23, QT_TRANSLATE_NOOP("QApplication", "Control 3 LSB")},
+    {0x24, QT_TRANSLATE_NOOP("QApplication", "Foot Controller LSB")},
+    {0x25, QT_TRANSLATE_NOOP("QApplication", "Portamento Time LSB")},
+    {0x26, QT_TRANSLATE_NOOP("QApplication", "Data Entry LSB")},
+    {0x27, QT_TRANSLATE_NOOP("QApplication", "Channel Volume LSB")},
+    {0x28, QT_TRANSLATE_NOOP("QApplication", "Balance LSB")},
+    {0x29, QT_TRANSLATE_NOOP("QApplication", "Control 9 LSB")},
+    {0x2a, QT_TRANSLATE_NOOP("QApplication", "Pan LSB")},
+    {0x2b, QT_TRANSLATE_NOOP("QApplication", "Expression Controller LSB")},
+    {0x2c, QT_TRANSLATE_NOOP("QApplication", "Effect Control 1 LSB")},
+    {0x2d, QT_TRANSLATE_NOOP("QApplication", "Effect Control 2 LSB")},
+    {0x2e, QT_TRANSLATE_NOOP("QApplication", "Control 14 LSB")},
+    {0x2f, QT_TRANSLATE_NOOP("QApplication", "Control 15 LSB")},
+    {0x30,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "General Purpose Controller 1 LSB")},
+    {0x31,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "General Purpose Controller 2 LSB")},
+    {0x32,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "General Purpose Controller 3 LSB")},
+    {0x33,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "General Purpose Controller 4 LSB")},
+    {0x34, QT_TRANSLATE_NOOP("QApplication", "Control 20 LSB")},
+    {0x35, QT_TRANSLATE_NOOP("QApplication", "Control 21 LSB")},
+    {0x36, QT_TRANSLATE_NOOP("QApplication", "Control 22 LSB")},
+    {0x37, QT_TRANSLATE_NOOP("QApplication", "Control 23 LSB")},
+    {0x38, QT_TRANSLATE_NOOP("QApplication", "Control 24 LSB")},
+    {0x39, QT_TRANSLATE_NOOP("QApplication", "Control 25 LSB")},
+    {0x3a, QT_TRANSLATE_NOOP("QApplication", "Control 26 LSB")},
+    {0x3b, QT_TRANSLATE_NOOP("QApplication", "Control 27 LSB")},
+    {0x3c, QT_TRANSLATE_NOOP("QApplication", "Control 28 LSB")},
+    {0x3d, QT_TRANSLATE_NOOP("QApplication", "Control 29 LSB")},
+    {0x3e, QT_TRANSLATE_NOOP("QApplication", "Control 30 LSB")},
+    {0x3f, QT_TRANSLATE_NOOP("QApplication", "Control 31 LSB")},
+    {0x40, QT_TRANSLATE_NOOP("QApplication", "Damper Pedal On/Off")},
+    {0x41, QT_TRANSLATE_NOOP("QApplication", "Portamento On/Off")},
+    {0x42, QT_TRANSLATE_NOOP("QApplication", "Sostenuto On/Off")},
+    {0x43, QT_TRANSLATE_NOOP("QApplication", "Soft Pedal On/Off")},
+    {0x44, QT_TRANSLATE_NOOP("QApplication", "Legato Footswitch")},
+    {0x45, QT_TRANSLATE_NOOP("QApplication", "Hold 2")},
+    {0x46,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "Sound Controller 1 (Default: Sound Variation)")},
+    {0x47,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "Sound Controller 2 (Default: Timbre/Harmonic "
+                       "Intensity)")},
+    {0x48,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "Sound Controller 3 (Default: Release Time)")},
+    {0x49,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "Sound Controller 4 (Default: Attack Time)")},
+    {0x4a,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "Sound Controller 5 (Default: Brightness)")},
+    {0x4b,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "Sound Controller 6 (Default: Decay Time)")},
+    {0x4c,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "Sound Controller 7 (Default: Vibrato Rate)")},
+    {0x4d,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "Sound Controller 8 (Default: Vibrato Depth)")},
+    {0x4e,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "Sound Controller 9 (Default: Vibrato Delay)")},
+    {0x4f, QT_TRANSLATE_NOOP("QApplication", "Sound Controller 10")},
+    {0x50,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "General Purpose Controller 5")},
+    {0x51,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "General Purpose Controller 6")},
+    {0x52,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "General Purpose Controller 7")},
+    {0x53,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "General Purpose Controller 8")},
+    {0x5b,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "Effects 1 Depth (Default: Reverb Send Level)")},
+    {0x5c, QT_TRANSLATE_NOOP("QApplication", "Effects 2 Depth")},
+    {0x5d,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "Effects 3 Depth (Default: Chorus Send Level")},
+    {0x5e, QT_TRANSLATE_NOOP("QApplication", "Effects 4 Depth")},
+    {0x5f, QT_TRANSLATE_NOOP("QApplication", "Effects 5 Depth")},
+    {0x60, QT_TRANSLATE_NOOP("QApplication", "Data Increment")},
+    {0x61, QT_TRANSLATE_NOOP("QApplication", "Data Decrement")},
+    {0x62,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "Non-Registered Parameter Number LSB")},
+    {0x63,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "Non-Registered Parameter Number MSB")},
+    {0x64,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "Registered Parameter Number LSB")},
+    {0x65,
+     QT_TRANSLATE_NOOP("QApplication",
+                       "Registered Parameter Number MSB")},
+    {0x78, QT_TRANSLATE_NOOP("QApplication", "All Sound Off")},
+    {0x79, QT_TRANSLATE_NOOP("QApplication", "Reset All Controllers")},
+    {0x7a, QT_TRANSLATE_NOOP("QApplication", "Local Control On/Off")},
+    {0x7b, QT_TRANSLATE_NOOP("QApplication", "All Notes Off")},
+    {0x7c, QT_TRANSLATE_NOOP("QApplication", "Omni Mode Off")},
+    {0x7d, QT_TRANSLATE_NOOP("QApplication", "Omni Mode On")},
+    {0x7e, QT_TRANSLATE_NOOP("QApplication", "Mono Mode On")},
+    {0x7f, QT_TRANSLATE_NOOP("QApplication", "Poly Mode On")}
+};
+
+static const NoteName noteNames[12] = {
+    {"cNote", QT_TRANSLATE_NOOP("cNote", "C")},
+    {"cSharpNote", QT_TRANSLATE_NOOP("cSharpNote", "C#")},
+    {"dNote", QT_TRANSLATE_NOOP("dNote", "D")},
+    {"dSharpNote", QT_TRANSLATE_NOOP("dSharpNote", "D#")},
+    {"eNote", QT_TRANSLATE_NOOP("eNote", "E")},
+    {"fNote", QT_TRANSLATE_NOOP("fNote", "F")},
+    {"fSharpNote", QT_TRANSLATE_NOOP("fSharpNote", "F#")},
+    {"gNote", QT_TRANSLATE_NOOP("gNote", "G")},
+    {"gSharpNote", QT_TRANSLATE_NOOP("gSharpNote", "G#")},
+    {"aNote", QT_TRANSLATE_NOOP("aNote", "A")},
+    {"aSharpNote", QT_TRANSLATE_NOOP("aSharpNote", "A#")},
+    {"bNote", QT_TRANSLATE_NOOP("bNote", "B")}
+};
+
+// Indexed by the high nibble of the status, minus 8.
+static const char *statusFormats[7] = {
+    QT_TRANSLATE_NOOP("MessageFormatter", "Note Off, Channel %1"),
+    QT_TRANSLATE_NOOP("MessageFormatter", "Note On, Channel %1"),
+    QT_TRANSLATE_NOOP("MessageFormatter", "Aftertouch, Channel %1"),
+    QT_TRANSLATE_NOOP("MessageFormatter", "Controller, Channel %1"),
+    QT_TRANSLATE_NOOP("MessageFormatter", "Program Change, Channel %1"),
+    QT_TRANSLATE_NOOP("MessageFormatter", "Channel Pressure, Channel %1"),
+    QT_TRANSLATE_NOOP("MessageFormatter", "Pitch Wheel, Channel %1")
+};
+
+// Class definition
+
+NameTables &
+NameTables::getInstance()
+{
+    static NameTables instance;
+    return instance;
+}
+
+NameTables::NameTables():
+    stale(true)
+{
+    // Empty
+}
+
+NameTables::~NameTables()
+{
+    // Empty
+}
+
+const QString &
+NameTables::getChannelStatusName(quint8 status)
+{
+    assert((status >= 0x80) && (status < 0xf0));
+    if (stale) {
+        update();
+    }
+    return channelStatusNames[status - 0x80];
+}
+
+const QString &
+NameTables::getControlName(quint8 control)
+{
+    assert(control < 0x80);
+    if (stale) {
+        update();
+    }
+    return controlNames[control];
+}
+
+const QString &
+NameTables::getNoteName(quint8 note)
+{
+    assert(note < 0x80);
+    if (stale) {
+        update();
+    }
+    return noteNames[note];
+}
+
+void
+NameTables::invalidate()
+{
+    stale = true;
+}
+
+void
+NameTables::update()
+{
+    QLocale locale = QLocale::system();
+
+    QString format = QCoreApplication::translate("midiControlFormat",
+                                                 "%1 - %2");
+    QString undefined = QCoreApplication::translate("QApplication",
+                                                    "Undefined");
+    QString names[0x80];
+    for (int i = 0; i < 0x80; i++) {
+        names[i] = undefined;
+    }
+    int count = static_cast<int>(sizeof(::controlNames) /
+                                 sizeof(::controlNames[0]));
+    for (int i = 0; i < count; i++) {
+        const ControlName &name = ::controlNames[i];
+        names[name.control] =
+            QCoreApplication::translate("QApplication", name.name);
+    }
+    for (int i = 0; i < 0x80; i++) {
+        controlNames[i] = format.arg(locale.toString(i), names[i]);
+    }
+
+    format = QCoreApplication::translate("midiNoteFormat", "%1 (%2%3)");
+    for (int i = 0; i < 0x80; i++) {
+        const NoteName &name = ::noteNames[i % 12];
+        noteNames[i] =
+            format.arg(locale.toString(i),
+                       QCoreApplication::translate(name.context, name.name),
+                       locale.toString((i / 12) - 1));
+    }
+
+    for (int i = 0; i < 7; i++) {
+        format = QCoreApplication::translate("MessageFormatter",
+                                             statusFormats[i]);
+        for (int j = 0; j < 0x10; j++) {
+            channelStatusNames[(i << 4) | j] = format.arg(j + 1);
+        }
+    }
+
+    stale = false;
+}
@@ -0,0 +1,70 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __NAMETABLES_H__
+#define __NAMETABLES_H__
+
+#include <QtCore/QString>
+
+// The names shown for MIDI notes, controllers and channel message statuses.
+// Every name is built once, and the names are only rebuilt after they're
+// invalidated, so getting a name is an array lookup that returns a reference
+// to a shared string.
+//
+// The tables are meant to be used from the GUI thread.
+
+class NameTables {
+
+public:
+
+    static NameTables &
+    getInstance();
+
+    // `status` must be a channel message status (0x80 - 0xef).
+    const QString &
+    getChannelStatusName(quint8 status);
+
+    const QString &
+    getControlName(quint8 control);
+
+    const QString &
+    getNoteName(quint8 note);
+
+    // Makes the names get rebuilt the next time one's needed.  Views call
+    // this when the application's translators or locale change.
+    void
+    invalidate();
+
+private:
+
+    NameTables();
+
+    ~NameTables();
+
+    void
+    update();
+
+    QString channelStatusNames[0x70];
+    QString controlNames[0x80];
+    QString noteNames[0x80];
+    bool stale;
+
+};
+
+#endif
@@ -0,0 +1,161 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <QtCore/QDebug>
+#include <QtCore/QVector>
+
+#ifdef MIDISNOOP_ALSA
+#include <cerrno>
+
+#include <QtCore/QSocketNotifier>
+
+#include <alsa/asoundlib.h>
+#endif
+
+#include "portwatcher.h"
+
+PortWatcher::PortWatcher(QObject *parent):
+    QObject(parent)
+{
+    connect(&pollTimer, SIGNAL(timeout()), SIGNAL(portsChanged()));
+    pollTimer.setInterval(2000);
+    running = false;
+
+#ifdef MIDISNOOP_ALSA
+    sequencer = 0;
+#endif
+
+}
+
+PortWatcher::~PortWatcher()
+{
+    stop();
+}
+
+void
+PortWatcher::handleAnnounceEvents()
+{
+
+#ifdef MIDISNOOP_ALSA
+    bool changed = false;
+    for (;;) {
+        snd_seq_event_t *event;
+        int result = snd_seq_event_input(sequencer, &event);
+        if (result == -ENOSPC) {
+
+            // Announcements were lost, so assume that something changed.
+            changed = true;
+            continue;
+        }
+        if (result < 0) {
+            break;
+        }
+        switch (event->type) {
+        case SND_SEQ_EVENT_CLIENT_CHANGE:
+        case SND_SEQ_EVENT_CLIENT_EXIT:
+        case SND_SEQ_EVENT_CLIENT_START:
+        case SND_SEQ_EVENT_PORT_CHANGE:
+        case SND_SEQ_EVENT_PORT_EXIT:
+        case SND_SEQ_EVENT_PORT_START:
+            changed = true;
+        }
+    }
+    if (changed) {
+        emit portsChanged();
+    }
+#endif
+
+}
+
+bool
+PortWatcher::isRunning() const
+{
+    return running;
+}
+
+void
+PortWatcher::start(RtMidi::Api api)
+{
+    stop();
+    running = true;
+    if ((api != RtMidi::LINUX_ALSA) || (! startAnnounceWatch())) {
+        pollTimer.start();
+    }
+}
+
+bool
+PortWatcher::startAnnounceWatch()
+{
+
+#ifdef MIDISNOOP_ALSA
+    if (snd_seq_open(&sequencer, "default", SND_SEQ_OPEN_INPUT,
+                     SND_SEQ_NONBLOCK) < 0) {
+        qWarning() << "failed to open ALSA sequencer for port announcements";
+        sequencer = 0;
+        return false;
+    }
+    snd_seq_set_client_name(sequencer, "midisnoop");
+    int port = snd_seq_create_simple_port
+        (sequencer, "Announce",
+         SND_SEQ_PORT_CAP_WRITE | SND_SEQ_PORT_CAP_NO_EXPORT,
+         SND_SEQ_PORT_TYPE_APPLICATION);
+    if ((port < 0) ||
+        (snd_seq_connect_from(sequencer, port, SND_SEQ_CLIENT_SYSTEM,
+                              SND_SEQ_PORT_SYSTEM_ANNOUNCE) < 0)) {
+        qWarning() << "failed to subscribe to ALSA port announcements";
+        snd_seq_close(sequencer);
+        sequencer = 0;
+        return false;
+    }
+    int count = snd_seq_poll_descriptors_count(sequencer, POLLIN);
+    QVector<pollfd> descriptors(count);
+    snd_seq_poll_descriptors(sequencer, descriptors.data(), count, POLLIN);
+    for (int i = 0; i < count; i++) {
+        QSocketNotifier *notifier =
+            new QSocketNotifier(descriptors[i].fd, QSocketNotifier::Read);
+        connect(notifier, SIGNAL(activated(int)),
+                SLOT(handleAnnounceEvents()));
+        notifiers.append(notifier);
+    }
+    return true;
+#else
+    return false;
+#endif
+
+}
+
+void
+PortWatcher::stop()
+{
+    if (! running) {
+        return;
+    }
+    pollTimer.stop();
+
+#ifdef MIDISNOOP_ALSA
+    if (sequencer) {
+        qDeleteAll(notifiers);
+        notifiers.clear();
+        snd_seq_close(sequencer);
+        sequencer = 0;
+    }
+#endif
+
+    running = false;
+}
@@ -0,0 +1,84 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __PORTWATCHER_H__
+#define __PORTWATCHER_H__
+
+#include <QtCore/QTimer>
+
+#include <RtMidi.h>
+
+#ifdef MIDISNOOP_ALSA
+class QSocketNotifier;
+typedef struct _snd_seq snd_seq_t;
+#endif
+
+// Watches for MIDI ports coming and going.  For the ALSA sequencer, the
+// watcher subscribes to the sequencer's announce port and reports changes as
+// they're announced.  For other drivers, or if the announce port can't be
+// used, the watcher asks for the port lists to be checked at a regular
+// interval.  Either way, `portsChanged` only means that the port lists might
+// have changed; it's up to the receiver to find out what changed.
+
+class PortWatcher: public QObject {
+
+    Q_OBJECT
+
+public:
+
+    explicit
+    PortWatcher(QObject *parent=0);
+
+    ~PortWatcher();
+
+    bool
+    isRunning() const;
+
+    void
+    start(RtMidi::Api api);
+
+    void
+    stop();
+
+signals:
+
+    void
+    portsChanged();
+
+private slots:
+
+    void
+    handleAnnounceEvents();
+
+private:
+
+    bool
+    startAnnounceWatch();
+
+    QTimer pollTimer;
+    bool running;
+
+#ifdef MIDISNOOP_ALSA
+    QList<QSocketNotifier *> notifiers;
+    snd_seq_t *sequencer;
+#endif
+
+};
+
+#endif
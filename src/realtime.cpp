@@ -0,0 +1,120 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+
+#include <QtCore/QtGlobal>
+
+#if defined(MIDISNOOP_PLATFORM_MACX) || defined(MIDISNOOP_PLATFORM_UNIX)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "realtime.h"
+
+RealTimeResult
+lockMemory(const void *address, std::size_t length)
+{
+
+#if defined(MIDISNOOP_PLATFORM_MACX) || defined(MIDISNOOP_PLATFORM_UNIX)
+    return mlock(address, length) ? REALTIMERESULT_FAILED :
+        REALTIMERESULT_SUCCEEDED;
+#else
+    Q_UNUSED(address);
+    Q_UNUSED(length);
+    return REALTIMERESULT_UNSUPPORTED;
+#endif
+
+}
+
+RealTimeResult
+setThreadAffinity(int cpu)
+{
+    assert(cpu >= -1);
+
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (cpu == -1) {
+        long count = sysconf(_SC_NPROCESSORS_CONF);
+        for (long i = 0; (i < count) && (i < CPU_SETSIZE); i++) {
+            CPU_SET(i, &cpus);
+        }
+    } else {
+        if (cpu >= CPU_SETSIZE) {
+            return REALTIMERESULT_FAILED;
+        }
+        CPU_SET(cpu, &cpus);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) ?
+        REALTIMERESULT_FAILED : REALTIMERESULT_SUCCEEDED;
+#else
+    return cpu == -1 ? REALTIMERESULT_SUCCEEDED : REALTIMERESULT_UNSUPPORTED;
+#endif
+
+}
+
+RealTimeResult
+setThreadScheduling(RealTimePolicy policy, int priority)
+{
+
+#if defined(MIDISNOOP_PLATFORM_MACX) || defined(MIDISNOOP_PLATFORM_UNIX)
+    int schedulingPolicy;
+    switch (policy) {
+    case REALTIMEPOLICY_FIFO:
+        schedulingPolicy = SCHED_FIFO;
+        break;
+    case REALTIMEPOLICY_ROUND_ROBIN:
+        schedulingPolicy = SCHED_RR;
+        break;
+    default:
+        schedulingPolicy = SCHED_OTHER;
+        priority = 0;
+    }
+    if (schedulingPolicy != SCHED_OTHER) {
+        priority = qBound(sched_get_priority_min(schedulingPolicy), priority,
+                          sched_get_priority_max(schedulingPolicy));
+    }
+    struct sched_param parameters;
+    parameters.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), schedulingPolicy,
+                                 &parameters) ? REALTIMERESULT_FAILED :
+        REALTIMERESULT_SUCCEEDED;
+#else
+    Q_UNUSED(policy);
+    Q_UNUSED(priority);
+    return REALTIMERESULT_UNSUPPORTED;
+#endif
+
+}
+
+void
+unlockMemory(const void *address, std::size_t length)
+{
+
+#if defined(MIDISNOOP_PLATFORM_MACX) || defined(MIDISNOOP_PLATFORM_UNIX)
+    munlock(address, length);
+#else
+    Q_UNUSED(address);
+    Q_UNUSED(length);
+#endif
+
+}
@@ -0,0 +1,64 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __REALTIME_H__
+#define __REALTIME_H__
+
+#include <cstddef>
+
+// Helpers for running capture threads in real-time mode.  The thread
+// functions act on the calling thread, so they're called from the MIDI
+// driver's callback thread, which midisnoop doesn't otherwise control.
+
+enum RealTimePolicy {
+    REALTIMEPOLICY_FIFO = 0,
+    REALTIMEPOLICY_ROUND_ROBIN = 1,
+    REALTIMEPOLICY_NORMAL = 2
+};
+
+enum RealTimeResult {
+    REALTIMERESULT_NONE = 0,
+    REALTIMERESULT_SUCCEEDED = 1,
+    REALTIMERESULT_FAILED = 2,
+    REALTIMERESULT_UNSUPPORTED = 3
+};
+
+// The outcome of each real-time mode step for a capture.
+struct RealTimeStatus {
+    RealTimeResult affinity;
+    RealTimeResult memoryLock;
+    RealTimeResult scheduling;
+};
+
+// Locks memory into RAM.  Locking also faults the memory in, so it won't
+// page fault when it's first written.
+RealTimeResult
+lockMemory(const void *address, std::size_t length);
+
+// Pins the calling thread to `cpu`, or lets it run on any CPU if `cpu` is -1.
+RealTimeResult
+setThreadAffinity(int cpu);
+
+RealTimeResult
+setThreadScheduling(RealTimePolicy policy, int priority);
+
+void
+unlockMemory(const void *address, std::size_t length);
+
+#endif
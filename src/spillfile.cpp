@@ -0,0 +1,210 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cstring>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+
+#include "error.h"
+#include "spillfile.h"
+
+// Static data
+
+static const quint64 segmentSize = 16 * 1024 * 1024;
+
+// Class definition
+
+SpillFile::SpillFile()
+{
+    position = 0;
+    releasedOffset = 0;
+    window = 0;
+    windowSegment = 0;
+}
+
+SpillFile::~SpillFile()
+{
+    close();
+}
+
+void
+SpillFile::close()
+{
+    QMutexLocker locker(&mutex);
+    if (window) {
+        windowSegment->file.unmap(window);
+        window = 0;
+        windowSegment = 0;
+    }
+    qDeleteAll(segments);
+    segments.clear();
+    position = 0;
+    releasedOffset = 0;
+}
+
+SpillFile::Segment *
+SpillFile::getSegment(quint64 index)
+{
+    // Segments are kept in order.  The one that's wanted is almost always the
+    // last one.
+    for (int i = segments.count() - 1; i >= 0; i--) {
+        Segment *segment = segments[i];
+        if (segment->index == index) {
+            return segment;
+        }
+        if (segment->index < index) {
+            break;
+        }
+    }
+    return 0;
+}
+
+bool
+SpillFile::isOpen() const
+{
+    return window != 0;
+}
+
+bool
+SpillFile::mapSegment(quint64 index)
+{
+    // The whole switch is done under the lock, so that `release` never
+    // deletes the segment that's mapped.
+    QMutexLocker locker(&mutex);
+    if (window) {
+        windowSegment->file.unmap(window);
+        window = 0;
+        windowSegment = 0;
+    }
+    Segment *segment = getSegment(index);
+    if (! segment) {
+        segment = new Segment();
+        segment->file.setFileTemplate
+            (QDir::temp().filePath("midisnoop-spill-XXXXXX"));
+        if (! (segment->file.open() &&
+               segment->file.resize(static_cast<qint64>(segmentSize)))) {
+            delete segment;
+            return false;
+        }
+        segment->index = index;
+        segment->path = segment->file.fileName();
+        segments.append(segment);
+    }
+    window = segment->file.map(0, static_cast<qint64>(segmentSize));
+    if (window) {
+        windowSegment = segment;
+    }
+    return window != 0;
+}
+
+void
+SpillFile::open()
+{
+    if (! window) {
+        position = 0;
+        releasedOffset = 0;
+        if (! mapSegment(0)) {
+            throw Error(qApp->translate("SpillFile",
+                                        "failed to open spill file"));
+        }
+    }
+}
+
+bool
+SpillFile::read(quint64 offset, quint32 length, quint8 *data)
+{
+    quint64 end = offset + length;
+    for (quint64 current = offset; current < end; ) {
+        quint64 index = current / segmentSize;
+        Segment *segment;
+        {
+            QMutexLocker locker(&mutex);
+            segment = (current < releasedOffset) ? 0 : getSegment(index);
+        }
+
+        // Segments are only deleted by `release`, which runs on this thread,
+        // so the segment can be read without the lock.
+        if (! segment) {
+            return false;
+        }
+        if (! segment->reader.isOpen()) {
+            segment->reader.setFileName(segment->path);
+            if (! segment->reader.open(QIODevice::ReadOnly)) {
+                return false;
+            }
+        }
+        quint64 segmentOffset = current - (index * segmentSize);
+        qint64 count =
+            static_cast<qint64>(qMin(segmentSize - segmentOffset,
+                                     end - current));
+        if ((! segment->reader.seek(static_cast<qint64>(segmentOffset))) ||
+            (segment->reader.read(reinterpret_cast<char *>
+                                  (data + (current - offset)), count) !=
+             count)) {
+            return false;
+        }
+        current += static_cast<quint64>(count);
+    }
+    return true;
+}
+
+void
+SpillFile::release(quint64 offset)
+{
+    QList<Segment *> released;
+    {
+        QMutexLocker locker(&mutex);
+        if (offset <= releasedOffset) {
+            return;
+        }
+        releasedOffset = offset;
+        while ((segments.count() > 1) &&
+               (((segments.first()->index + 1) * segmentSize) <= offset) &&
+               (segments.first() != windowSegment)) {
+            released.append(segments.takeFirst());
+        }
+    }
+
+    // Files are deleted without holding the lock, so the writer isn't kept
+    // waiting.
+    qDeleteAll(released);
+}
+
+bool
+SpillFile::write(const quint8 *data, quint32 length, quint64 &offset)
+{
+    offset = position;
+    quint64 end = position + length;
+    while (position < end) {
+        quint64 index = position / segmentSize;
+        if ((! window) || (windowSegment->index != index)) {
+            if (! mapSegment(index)) {
+                position = offset;
+                return false;
+            }
+        }
+        quint64 segmentOffset = position - (index * segmentSize);
+        quint64 count = qMin(segmentSize - segmentOffset, end - position);
+        std::memcpy(window + segmentOffset, data + (position - offset),
+                    static_cast<size_t>(count));
+        position += count;
+    }
+    return true;
+}
@@ -0,0 +1,95 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __SPILLFILE_H__
+#define __SPILLFILE_H__
+
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QTemporaryFile>
+
+// Temporary files that hold the payloads of large system exclusive messages.
+// Payloads are written at increasing offsets into a sequence of segments,
+// each a temporary file of its own that's memory-mapped while it's written
+// to, so memory use stays bounded no matter how much data is written.
+//
+// Writing is done from a single thread (the MIDI driver's thread).  Reading
+// and releasing are done from another thread (the GUI thread).  Once every
+// payload in a segment has been released, the segment's file is deleted, so
+// the disk space used follows the messages that are still shown.  The
+// writer only takes the lock when it moves on to a new segment.
+
+class SpillFile {
+
+public:
+
+    SpillFile();
+
+    ~SpillFile();
+
+    void
+    close();
+
+    bool
+    isOpen() const;
+
+    void
+    open();
+
+    bool
+    read(quint64 offset, quint32 length, quint8 *data);
+
+    // Releases the payloads that end at or before `offset`.
+    void
+    release(quint64 offset);
+
+    bool
+    write(const quint8 *data, quint32 length, quint64 &offset);
+
+private:
+
+    struct Segment {
+        QTemporaryFile file;
+        quint64 index;
+        QString path;
+        QFile reader;
+    };
+
+    SpillFile(const SpillFile &);
+
+    SpillFile &
+    operator=(const SpillFile &);
+
+    Segment *
+    getSegment(quint64 index);
+
+    bool
+    mapSegment(quint64 index);
+
+    QMutex mutex;
+    quint64 position;
+    quint64 releasedOffset;
+    QList<Segment *> segments;
+    uchar *window;
+    Segment *windowSegment;
+
+};
+
+#endif
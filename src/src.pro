@@ -39,6 +39,14 @@ macx {
     warning(Your platform has not been detected successfully.  Expect errors.)
 }
 
+unix:!macx {
+    packagesExist(alsa) {
+        CONFIG += link_pkgconfig
+        DEFINES += MIDISNOOP_ALSA
+        PKGCONFIG += alsa
+    }
+}
+
 isEmpty(PREFIX) {
     win32 {
         PREFIX = C:/Program Files/midisnoop
@@ -70,6 +78,12 @@ DEFINES += MIDISNOOP_MAJOR_VERSION=$${MAJOR_VERSION} \
 DESTDIR = $${BUILDDIR}/$${MIDISNOOP_APP_SUFFIX}
 HEADERS += aboutview.h \
     application.h \
+    bytes.h \
+    captureclock.h \
+    capturefile.h \
+    captureloader.h \
+    clockanalyzer.h \
+    clockview.h \
     closeeventfilter.h \
     configureview.h \
     controller.h \
@@ -78,9 +92,32 @@ HEADERS += aboutview.h \
     engine.h \
     error.h \
     errorview.h \
+    eventblock.h \
+    filterview.h \
+    hexparser.h \
+    latencystatistics.h \
     mainview.h \
+    messageannotator.h \
+    messagebatch.h \
+    messagedecoder.h \
+    messagefilter.h \
+    messagefiltereditor.h \
+    messagefiltermodel.h \
+    messageformatter.h \
+    messageindex.h \
+    messagequeue.h \
+    midievent.h \
     messagetabledelegate.h \
+    messagetablemodel.h \
     messageview.h \
+    nametables.h \
+    portwatcher.h \
+    realtime.h \
+    spillfile.h \
+    sysexarena.h \
+    sysexdecoderregistry.h \
+    umpdecoder.h \
+    umptranslator.h \
     util.h \
     view.h
 LIBS += -lrtmidi
@@ -91,6 +128,12 @@ RCC_DIR = $${MAKEDIR}
 RESOURCES += resources.qrc
 SOURCES += aboutview.cpp \
     application.cpp \
+    bytes.cpp \
+    captureclock.cpp \
+    capturefile.cpp \
+    captureloader.cpp \
+    clockanalyzer.cpp \
+    clockview.cpp \
     closeeventfilter.cpp \
     configureview.cpp \
     controller.cpp \
@@ -99,10 +142,31 @@ SOURCES += aboutview.cpp \
     engine.cpp \
     error.cpp \
     errorview.cpp \
+    eventblock.cpp \
+    filterview.cpp \
+    hexparser.cpp \
+    latencystatistics.cpp \
     main.cpp \
     mainview.cpp \
+    messageannotator.cpp \
+    messagedecoder.cpp \
+    messagefilter.cpp \
+    messagefiltereditor.cpp \
+    messagefiltermodel.cpp \
+    messageformatter.cpp \
+    messageindex.cpp \
+    messagequeue.cpp \
     messagetabledelegate.cpp \
+    messagetablemodel.cpp \
     messageview.cpp \
+    nametables.cpp \
+    portwatcher.cpp \
+    realtime.cpp \
+    spillfile.cpp \
+    sysexarena.cpp \
+    sysexdecoderregistry.cpp \
+    umpdecoder.cpp \
+    umptranslator.cpp \
     util.cpp \
     view.cpp
 TARGET = midisnoop
@@ -0,0 +1,106 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "sysexarena.h"
+
+SysExArena::SysExArena(quint32 chunkSize)
+{
+    assert(chunkSize);
+    chunk = -1;
+    this->chunkSize = chunkSize;
+    position = 0;
+}
+
+SysExArena::~SysExArena()
+{
+    for (int i = chunks.count() - 1; i >= 0; i--) {
+        delete[] chunks[i].data;
+    }
+}
+
+quint32
+SysExArena::append(const quint8 *data, quint32 length)
+{
+    if ((chunk == -1) || ((chunks[chunk].size - position) < length)) {
+
+        // Move on to the next chunk, replacing it if it's too small for the
+        // payload.  Chunks past the current chunk are unused, so replacing
+        // them doesn't invalidate any offsets.
+        quint32 base = (chunk == -1) ? 0 :
+            chunks[chunk].base + chunks[chunk].size;
+        quint32 size = qMax(chunkSize,
+                            ((length + chunkSize - 1) / chunkSize) *
+                            chunkSize);
+        chunk++;
+        if (chunk == chunks.count()) {
+            Chunk newChunk;
+            newChunk.data = new quint8[size];
+            newChunk.size = size;
+            chunks.append(newChunk);
+        } else if (chunks[chunk].size < length) {
+            delete[] chunks[chunk].data;
+            chunks[chunk].data = new quint8[size];
+            chunks[chunk].size = size;
+        }
+        chunks[chunk].base = base;
+        position = 0;
+    }
+    Chunk &current = chunks[chunk];
+    std::memcpy(current.data + position, data, length);
+    quint32 offset = current.base + position;
+    position += length;
+    return offset;
+}
+
+void
+SysExArena::clear()
+{
+    chunk = -1;
+    position = 0;
+}
+
+const quint8 *
+SysExArena::getData(quint32 offset) const
+{
+    assert(chunk != -1);
+
+    // Find the last chunk in use with a base at or below the offset.
+    int low = 0;
+    int high = chunk;
+    while (low < high) {
+        int middle = (low + high + 1) / 2;
+        if (chunks[middle].base <= offset) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    const Chunk &found = chunks[low];
+    assert((offset - found.base) < found.size);
+    return found.data + (offset - found.base);
+}
+
+bool
+SysExArena::isEmpty() const
+{
+    return chunk == -1;
+}
@@ -0,0 +1,72 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __SYSEXARENA_H__
+#define __SYSEXARENA_H__
+
+#include <QtCore/QVector>
+
+// A chunked arena for the payloads of long MIDI messages.  Payloads are
+// appended and referenced by offset; each payload is stored contiguously, in
+// a chunk of its own if it's larger than the chunk size.  Clearing the arena
+// keeps its chunks for reuse, so an arena that's cleared regularly stops
+// allocating once it reaches its working size.
+
+class SysExArena {
+
+public:
+
+    explicit
+    SysExArena(quint32 chunkSize=65536);
+
+    ~SysExArena();
+
+    quint32
+    append(const quint8 *data, quint32 length);
+
+    void
+    clear();
+
+    const quint8 *
+    getData(quint32 offset) const;
+
+    bool
+    isEmpty() const;
+
+private:
+
+    struct Chunk {
+        quint32 base;
+        quint8 *data;
+        quint32 size;
+    };
+
+    SysExArena(const SysExArena &);
+
+    SysExArena &
+    operator=(const SysExArena &);
+
+    int chunk;
+    QVector<Chunk> chunks;
+    quint32 chunkSize;
+    quint32 position;
+
+};
+
+#endif
@@ -0,0 +1,352 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "messageformatter.h"
+#include "sysexdecoderregistry.h"
+
+// Static data
+
+// Manufacturer IDs are mapped to indexes into a flat table.  One-byte IDs
+// keep their value, and three-byte IDs follow them.
+static const int manufacturerCount = 0x80 + 0x4000;
+
+static const quint8 generalMIDIKey[] = { 0x7e, 0x09 };
+static const quint8 identityReplyKey[] = { 0x7e, 0x06, 0x02 };
+static const quint8 identityRequestKey[] = { 0x7e, 0x06, 0x01 };
+static const quint8 mmcCommandKey[] = { 0x7f, 0x06 };
+static const quint8 mtcFullFrameKey[] = { 0x7f, 0x01, 0x01 };
+static const quint8 sampleDumpHeaderKey[] = { 0x7e, 0x01 };
+
+// Static functions
+
+QString
+SysExDecoderRegistry::decodeGeneralMIDIMessage(const SysExMessage &message)
+{
+    if (message.length != 1) {
+        return QString();
+    }
+    QString device = getDeviceString(message.device);
+    switch (message.data[0]) {
+    case 0x01:
+        return tr("General MIDI System On (%1)").arg(device);
+    case 0x02:
+        return tr("General MIDI System Off (%1)").arg(device);
+    case 0x03:
+        return tr("General MIDI 2 System On (%1)").arg(device);
+    default:
+        return QString();
+    }
+}
+
+QString
+SysExDecoderRegistry::decodeIdentityReply(const SysExMessage &message)
+{
+    const quint8 *data = message.data;
+    quint32 idLength;
+    if (getManufacturerIndex(data, message.length, idLength) == -1) {
+        return QString();
+    }
+    if ((message.length - idLength) != 8) {
+        return QString();
+    }
+    const quint8 *fields = data + idLength;
+    return tr("Identity Reply (%1): Manufacturer: %2, Family: %3, "
+              "Member: %4, Version: %5").
+        arg(getDeviceString(message.device),
+            MessageFormatter::getHexString(data, idLength)).
+        arg(fields[0] | (fields[1] << 7)).
+        arg(fields[2] | (fields[3] << 7)).
+        arg(MessageFormatter::getHexString(fields + 4, 4));
+}
+
+QString
+SysExDecoderRegistry::decodeIdentityRequest(const SysExMessage &message)
+{
+    if (message.length) {
+        return QString();
+    }
+    return tr("Identity Request (%1)").arg(getDeviceString(message.device));
+}
+
+QString
+SysExDecoderRegistry::decodeMMCCommand(const SysExMessage &message)
+{
+    if (! message.length) {
+        return QString();
+    }
+    const quint8 *data = message.data;
+    QString command;
+    switch (data[0]) {
+    case 0x01:
+        command = tr("Stop");
+        break;
+    case 0x02:
+        command = tr("Play");
+        break;
+    case 0x03:
+        command = tr("Deferred Play");
+        break;
+    case 0x04:
+        command = tr("Fast Forward");
+        break;
+    case 0x05:
+        command = tr("Rewind");
+        break;
+    case 0x06:
+        command = tr("Record Strobe");
+        break;
+    case 0x07:
+        command = tr("Record Exit");
+        break;
+    case 0x08:
+        command = tr("Record Pause");
+        break;
+    case 0x09:
+        command = tr("Pause");
+        break;
+    case 0x0a:
+        command = tr("Eject");
+        break;
+    case 0x0b:
+        command = tr("Chase");
+        break;
+    case 0x0c:
+        command = tr("Command Error Reset");
+        break;
+    case 0x0d:
+        command = tr("MMC Reset");
+        break;
+    case 0x40:
+        command = tr("Write");
+        break;
+    case 0x44:
+
+        // Only the 'target' form of the locate command is described.
+        if ((message.length == 8) && (data[1] == 0x06) && (data[2] == 0x01)) {
+            command = tr("Locate %1").arg(getTimeString(data + 3));
+        } else {
+            command = tr("Locate");
+        }
+        break;
+    case 0x47:
+        command = tr("Shuttle");
+        break;
+    default:
+        command = tr("Command %1").
+            arg(static_cast<uint>(data[0]), 2, 16, QChar('0'));
+    }
+    return tr("MMC %1 (%2)").arg(command, getDeviceString(message.device));
+}
+
+QString
+SysExDecoderRegistry::decodeMTCFullFrame(const SysExMessage &message)
+{
+    if (message.length != 4) {
+        return QString();
+    }
+    return tr("MTC Full Frame (%1): %2").
+        arg(getDeviceString(message.device), getTimeString(message.data));
+}
+
+QString
+SysExDecoderRegistry::decodeSampleDumpHeader(const SysExMessage &message)
+{
+    if (message.length != 17) {
+        return QString();
+    }
+    const quint8 *data = message.data;
+    quint32 period = data[3] | (data[4] << 7) | (data[5] << 14);
+    quint32 length = data[6] | (data[7] << 7) | (data[8] << 14);
+    quint32 loopStart = data[9] | (data[10] << 7) | (data[11] << 14);
+    quint32 loopEnd = data[12] | (data[13] << 7) | (data[14] << 14);
+    QString loop;
+    switch (data[15]) {
+    case 0x00:
+        loop = tr("%1-%2 (forward)").arg(loopStart).arg(loopEnd);
+        break;
+    case 0x01:
+        loop = tr("%1-%2 (alternating)").arg(loopStart).arg(loopEnd);
+        break;
+    default:
+        loop = tr("off");
+    }
+
+    // The sample period is given in nanoseconds.
+    return tr("Sample Dump Header (%1): Sample: %2, Format: %3-bit, "
+              "Rate: %4 Hz, Length: %5 words, Loop: %6").
+        arg(getDeviceString(message.device)).
+        arg(data[0] | (data[1] << 7)).
+        arg(data[2]).
+        arg(period ? (1000000000.0 / period) : 0.0, 0, 'f', 0).
+        arg(length).
+        arg(loop);
+}
+
+QString
+SysExDecoderRegistry::getDeviceString(quint8 device)
+{
+    return device == 0x7f ? tr("all devices") : tr("device %1").arg(device);
+}
+
+int
+SysExDecoderRegistry::getManufacturerIndex(const quint8 *data,
+                                           quint32 length,
+                                           quint32 &idLength)
+{
+    if (! length) {
+        return -1;
+    }
+    if (data[0]) {
+        idLength = 1;
+        return data[0];
+    }
+    if (length < 3) {
+        return -1;
+    }
+    idLength = 3;
+    return 0x80 + ((data[1] << 7) | data[2]);
+}
+
+SysExDecoderRegistry &
+SysExDecoderRegistry::getInstance()
+{
+    static SysExDecoderRegistry registry;
+    return registry;
+}
+
+QString
+SysExDecoderRegistry::getTimeString(const quint8 *data)
+{
+    // The hours byte also holds the SMPTE type.
+    return tr("%1:%2:%3:%4 (%5)").
+        arg(data[0] & 0x1f, 2, 10, QChar('0')).
+        arg(data[1], 2, 10, QChar('0')).
+        arg(data[2], 2, 10, QChar('0')).
+        arg(data[3], 2, 10, QChar('0')).
+        arg(MessageFormatter::getSMPTETypeString((data[0] >> 5) & 0x3));
+}
+
+// Class definition
+
+SysExDecoderRegistry::SysExDecoderRegistry():
+    manufacturerNodes(manufacturerCount, 0),
+    nodes(1)
+{
+    registerDecoder(generalMIDIKey, sizeof(generalMIDIKey),
+                    decodeGeneralMIDIMessage);
+    registerDecoder(identityReplyKey, sizeof(identityReplyKey),
+                    decodeIdentityReply);
+    registerDecoder(identityRequestKey, sizeof(identityRequestKey),
+                    decodeIdentityRequest);
+    registerDecoder(mmcCommandKey, sizeof(mmcCommandKey), decodeMMCCommand);
+    registerDecoder(mtcFullFrameKey, sizeof(mtcFullFrameKey),
+                    decodeMTCFullFrame);
+    registerDecoder(sampleDumpHeaderKey, sizeof(sampleDumpHeaderKey),
+                    decodeSampleDumpHeader);
+}
+
+SysExDecoderRegistry::~SysExDecoderRegistry()
+{
+    // Empty
+}
+
+QString
+SysExDecoderRegistry::decode(const quint8 *data, quint32 length) const
+{
+    quint32 offset;
+    int index = getManufacturerIndex(data, length, offset);
+    if (index == -1) {
+        return QString();
+    }
+    int node = manufacturerNodes[index];
+    if (! node) {
+        return QString();
+    }
+    SysExMessage message;
+    message.device = 0;
+    if ((index == 0x7e) || (index == 0x7f)) {
+        if (offset == length) {
+            return QString();
+        }
+        message.device = data[offset++];
+    }
+
+    // Follow the sub-IDs as far as the trie goes, remembering the last
+    // decoder on the way.
+    Decoder decoder = nodes[node].decoder;
+    quint32 end = offset;
+    for (; offset < length; offset++) {
+        quint8 subId = data[offset];
+        if (subId & 0x80) {
+            break;
+        }
+        node = nodes[node].children[subId];
+        if (! node) {
+            break;
+        }
+        if (nodes[node].decoder) {
+            decoder = nodes[node].decoder;
+            end = offset + 1;
+        }
+    }
+    if (! decoder) {
+        return QString();
+    }
+    message.data = data + end;
+    message.length = length - end;
+    return decoder(message);
+}
+
+void
+SysExDecoderRegistry::registerDecoder(const quint8 *key, int keyLength,
+                                      Decoder decoder)
+{
+    assert(key);
+    assert(decoder);
+    quint32 idLength;
+    int index = getManufacturerIndex(key, static_cast<quint32>(keyLength),
+                                     idLength);
+    assert(index != -1);
+    assert((keyLength - static_cast<int>(idLength)) <= MAXIMUM_SUB_ID_COUNT);
+
+    Node emptyNode;
+    std::memset(emptyNode.children, 0, sizeof(emptyNode.children));
+    emptyNode.decoder = 0;
+    int node = manufacturerNodes[index];
+    if (! node) {
+        node = nodes.count();
+        nodes.append(emptyNode);
+        manufacturerNodes[index] = node;
+    }
+    for (int i = static_cast<int>(idLength); i < keyLength; i++) {
+        quint8 subId = key[i];
+        assert(! (subId & 0x80));
+        int child = nodes[node].children[subId];
+        if (! child) {
+            child = nodes.count();
+            nodes.append(emptyNode);
+            nodes[node].children[subId] = child;
+        }
+        node = child;
+    }
+    nodes[node].decoder = decoder;
+}
@@ -0,0 +1,118 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __SYSEXDECODERREGISTRY_H__
+#define __SYSEXDECODERREGISTRY_H__
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+// The part of a system exclusive message that a decoder is given.  `data`
+// holds the bytes that follow the decoder's key, up to (but not including)
+// the end byte.  `device` is the device ID of a universal message, and is
+// zero for other messages.
+
+struct SysExMessage {
+    const quint8 *data;
+    quint8 device;
+    quint32 length;
+};
+
+// Describes system exclusive messages.  Decoders are registered under a key:
+// a manufacturer ID (one byte, or three bytes starting with 0x00) followed
+// by up to two sub-IDs.  The sub-IDs of a universal message (manufacturer ID
+// 0x7e or 0x7f) follow its device ID; for other messages, they directly
+// follow the manufacturer ID.  A message is described by the decoder with the
+// longest key that matches it.
+//
+// Keys are kept in a trie of flat, 128-way nodes, so finding a message's
+// decoder takes at most three array lookups.  The registry comes with
+// decoders for common universal messages, and is meant to be used from the
+// GUI thread.
+
+class SysExDecoderRegistry {
+
+    Q_DECLARE_TR_FUNCTIONS(SysExDecoderRegistry)
+
+public:
+
+    // Returns a null string if the message can't be described.
+    typedef QString (*Decoder)(const SysExMessage &message);
+
+    static SysExDecoderRegistry &
+    getInstance();
+
+    // `data` holds the bytes between a system exclusive message's status and
+    // end bytes.  Returns a null string if no decoder describes the message.
+    QString
+    decode(const quint8 *data, quint32 length) const;
+
+    void
+    registerDecoder(const quint8 *key, int keyLength, Decoder decoder);
+
+private:
+
+    struct Node {
+        int children[0x80];
+        Decoder decoder;
+    };
+
+    static const int MAXIMUM_SUB_ID_COUNT = 2;
+
+    static QString
+    decodeGeneralMIDIMessage(const SysExMessage &message);
+
+    static QString
+    decodeIdentityReply(const SysExMessage &message);
+
+    static QString
+    decodeIdentityRequest(const SysExMessage &message);
+
+    static QString
+    decodeMMCCommand(const SysExMessage &message);
+
+    static QString
+    decodeMTCFullFrame(const SysExMessage &message);
+
+    static QString
+    decodeSampleDumpHeader(const SysExMessage &message);
+
+    static QString
+    getDeviceString(quint8 device);
+
+    // Returns -1 if `data` doesn't start with a complete manufacturer ID.
+    static int
+    getManufacturerIndex(const quint8 *data, quint32 length,
+                         quint32 &idLength);
+
+    static QString
+    getTimeString(const quint8 *data);
+
+    SysExDecoderRegistry();
+
+    ~SysExDecoderRegistry();
+
+    // Node 0 is never used, so that 0 can mean 'no node'.
+    QVector<int> manufacturerNodes;
+    QVector<Node> nodes;
+
+};
+
+#endif
@@ -0,0 +1,125 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "umpdecoder.h"
+
+// Static data
+
+// MIDI 2.0 channel voice messages, indexed by the status nibble.
+static const quint8 channelVoiceKinds[16] = {
+    DecodedUMPMessage::KIND_REGISTERED_PER_NOTE_CONTROLLER,
+    DecodedUMPMessage::KIND_ASSIGNABLE_PER_NOTE_CONTROLLER,
+    DecodedUMPMessage::KIND_REGISTERED_CONTROLLER,
+    DecodedUMPMessage::KIND_ASSIGNABLE_CONTROLLER,
+    DecodedUMPMessage::KIND_RELATIVE_REGISTERED_CONTROLLER,
+    DecodedUMPMessage::KIND_RELATIVE_ASSIGNABLE_CONTROLLER,
+    DecodedUMPMessage::KIND_PER_NOTE_PITCH_BEND,
+    DecodedUMPMessage::KIND_INVALID,
+    DecodedUMPMessage::KIND_NOTE_OFF,
+    DecodedUMPMessage::KIND_NOTE_ON,
+    DecodedUMPMessage::KIND_POLYPHONIC_PRESSURE,
+    DecodedUMPMessage::KIND_CONTROL_CHANGE,
+    DecodedUMPMessage::KIND_PROGRAM_CHANGE,
+    DecodedUMPMessage::KIND_CHANNEL_PRESSURE,
+    DecodedUMPMessage::KIND_PITCH_BEND,
+    DecodedUMPMessage::KIND_PER_NOTE_MANAGEMENT
+};
+
+// Functions
+
+DecodedUMPMessage
+decodeUMPMessage(const quint32 *words, int count)
+{
+    DecodedUMPMessage decoded;
+    decoded.attribute = 0;
+    decoded.attributeType = 0;
+    decoded.bank = 0;
+    decoded.channel = 0;
+    decoded.group = 0;
+    decoded.kind = DecodedUMPMessage::KIND_INVALID;
+    decoded.number = 0;
+    decoded.type = 0;
+    decoded.value = 0;
+    if ((count <= 0) || (count != getUMPPacketSize(words[0]))) {
+        return decoded;
+    }
+    quint32 word = words[0];
+    decoded.type = static_cast<quint8>(word >> 28);
+    decoded.group = static_cast<quint8>((word >> 24) & 0xf);
+    if (decoded.type != 0x4) {
+        decoded.kind = DecodedUMPMessage::KIND_OTHER;
+        return decoded;
+    }
+    decoded.kind = channelVoiceKinds[(word >> 20) & 0xf];
+    decoded.channel = static_cast<quint8>((word >> 16) & 0xf);
+    quint8 byte3 = static_cast<quint8>((word >> 8) & 0xff);
+    quint8 byte4 = static_cast<quint8>(word & 0xff);
+    quint32 data = words[1];
+    switch (decoded.kind) {
+    case DecodedUMPMessage::KIND_NOTE_OFF:
+    case DecodedUMPMessage::KIND_NOTE_ON:
+        decoded.number = byte3 & 0x7f;
+        decoded.attributeType = byte4;
+        decoded.attribute = static_cast<quint16>(data & 0xffff);
+        decoded.value = data >> 16;
+        break;
+    case DecodedUMPMessage::KIND_REGISTERED_PER_NOTE_CONTROLLER:
+    case DecodedUMPMessage::KIND_ASSIGNABLE_PER_NOTE_CONTROLLER:
+    case DecodedUMPMessage::KIND_REGISTERED_CONTROLLER:
+    case DecodedUMPMessage::KIND_ASSIGNABLE_CONTROLLER:
+    case DecodedUMPMessage::KIND_RELATIVE_REGISTERED_CONTROLLER:
+    case DecodedUMPMessage::KIND_RELATIVE_ASSIGNABLE_CONTROLLER:
+
+        // Per-note controllers carry the note where other controllers carry
+        // the bank.
+        if (decoded.kind <=
+            DecodedUMPMessage::KIND_ASSIGNABLE_PER_NOTE_CONTROLLER) {
+            decoded.number = byte3 & 0x7f;
+            decoded.bank = byte4;
+        } else {
+            decoded.bank = byte3 & 0x7f;
+            decoded.number = byte4 & 0x7f;
+        }
+        decoded.value = data;
+        break;
+    case DecodedUMPMessage::KIND_POLYPHONIC_PRESSURE:
+    case DecodedUMPMessage::KIND_PER_NOTE_PITCH_BEND:
+    case DecodedUMPMessage::KIND_CONTROL_CHANGE:
+        decoded.number = byte3 & 0x7f;
+        decoded.value = data;
+        break;
+    case DecodedUMPMessage::KIND_PROGRAM_CHANGE:
+        decoded.bank = byte4 & 0x1;
+        decoded.number = static_cast<quint8>((data >> 24) & 0x7f);
+        decoded.attribute = static_cast<quint16>((((data >> 8) & 0x7f) << 8) |
+                                                 (data & 0x7f));
+        break;
+    case DecodedUMPMessage::KIND_CHANNEL_PRESSURE:
+    case DecodedUMPMessage::KIND_PITCH_BEND:
+        decoded.value = data;
+        break;
+    case DecodedUMPMessage::KIND_PER_NOTE_MANAGEMENT:
+        decoded.number = byte3 & 0x7f;
+        decoded.attribute = byte4 & 0x3;
+        break;
+    default:
+        ;
+    }
+    return decoded;
+}
@@ -0,0 +1,102 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __UMPDECODER_H__
+#define __UMPDECODER_H__
+
+#include <QtCore/QtGlobal>
+
+// The result of decoding a Universal MIDI Packet (UMP).  Like
+// `decodeMessage`, decoding only extracts fields, and `MessageFormatter`
+// turns the result into text.  Only MIDI 2.0 channel voice messages (message
+// type 0x4) are decoded into fields; other packets are only checked for
+// length.
+//
+// The meaning of `number`, `bank` and `value` depends on the kind of
+// message:
+//
+//   - Note messages: `number` is the note, and `value` is the 16-bit
+//     velocity.  `attributeType` and `attribute` hold the note attribute.
+//   - Polyphonic pressure and per-note pitch bend messages: `number` is the
+//     note, and `value` is the 32-bit pressure or bend
+//   - Per-note controllers: `number` is the note, `bank` is the controller
+//     index, and `value` is the 32-bit value
+//   - Registered and assignable controllers (RPNs and NRPNs): `bank` and
+//     `number` are the controller's bank and index, and `value` is the
+//     32-bit value (signed, for relative controllers)
+//   - Control change messages: `number` is the controller, and `value` is the
+//     32-bit value
+//   - Program change messages: `number` is the program, and `bank` and
+//     `attribute` say whether a bank is given (`bank` is non-zero) and which
+//     one (MSB in the high byte)
+//   - Channel pressure and pitch bend messages: `value` is the 32-bit
+//     pressure or bend (pitch bend is centred on 0x80000000)
+//   - Per-note management messages: `number` is the note, and `attribute`
+//     holds the detach (bit 1) and reset (bit 0) flags
+
+struct DecodedUMPMessage {
+
+    enum Kind {
+        KIND_INVALID = 0,
+        KIND_OTHER,
+
+        // MIDI 2.0 channel voice messages
+        KIND_REGISTERED_PER_NOTE_CONTROLLER,
+        KIND_ASSIGNABLE_PER_NOTE_CONTROLLER,
+        KIND_REGISTERED_CONTROLLER,
+        KIND_ASSIGNABLE_CONTROLLER,
+        KIND_RELATIVE_REGISTERED_CONTROLLER,
+        KIND_RELATIVE_ASSIGNABLE_CONTROLLER,
+        KIND_PER_NOTE_PITCH_BEND,
+        KIND_NOTE_OFF,
+        KIND_NOTE_ON,
+        KIND_POLYPHONIC_PRESSURE,
+        KIND_CONTROL_CHANGE,
+        KIND_PROGRAM_CHANGE,
+        KIND_CHANNEL_PRESSURE,
+        KIND_PITCH_BEND,
+        KIND_PER_NOTE_MANAGEMENT
+    };
+
+    quint16 attribute;
+    quint8 attributeType;
+    quint8 bank;
+    quint8 channel;
+    quint8 group;
+    quint8 kind;
+    quint8 number;
+    quint8 type;
+    quint32 value;
+
+};
+
+DecodedUMPMessage
+decodeUMPMessage(const quint32 *words, int count);
+
+// Returns the number of 32-bit words in the packet that starts with `word`.
+inline int
+getUMPPacketSize(quint32 word)
+{
+    static const quint8 sizes[16] = {
+        1, 1, 1, 2, 2, 4, 1, 1, 2, 2, 2, 3, 3, 4, 4, 4
+    };
+    return sizes[word >> 28];
+}
+
+#endif
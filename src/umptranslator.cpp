@@ -0,0 +1,260 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "messagedecoder.h"
+#include "umptranslator.h"
+
+// Static data
+
+// The status nibbles of 7-bit system exclusive packets.
+enum SysExPacketStatus {
+    SYSEXPACKETSTATUS_COMPLETE = 0,
+    SYSEXPACKETSTATUS_START = 1,
+    SYSEXPACKETSTATUS_CONTINUE = 2,
+    SYSEXPACKETSTATUS_END = 3
+};
+
+// Static functions
+
+// Returns the length of the MIDI 1.0 message with the given status byte, or
+// 0 if the message can't be carried in a type 0x1 or 0x2 packet.
+static int
+getMessageLength(quint8 status)
+{
+    if (status < 0x80) {
+        return 0;
+    }
+    if (status < 0xf0) {
+        return ((status & 0xe0) == 0xc0) ? 2 : 3;
+    }
+    switch (status) {
+    case 0xf1:
+    case 0xf3:
+        return 2;
+    case 0xf2:
+        return 3;
+    case 0xf6:
+    case 0xf8:
+    case 0xf9:
+    case 0xfa:
+    case 0xfb:
+    case 0xfc:
+    case 0xfe:
+    case 0xff:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+// Functions
+
+quint32
+scaleUp(quint32 value, int sourceBits, int destinationBits)
+{
+    // Values up to the centre are shifted.  Above the centre, the bits below
+    // the source's top bit are repeated to fill the new low bits, so that the
+    // maximum maps onto the maximum.
+    int scaleBits = destinationBits - sourceBits;
+    quint32 scaled = value << scaleBits;
+    if (value <= (1U << (sourceBits - 1))) {
+        return scaled;
+    }
+    int repeatBits = sourceBits - 1;
+    quint32 repeatValue = value & ((1U << repeatBits) - 1);
+    if (scaleBits > repeatBits) {
+        repeatValue <<= scaleBits - repeatBits;
+    } else {
+        repeatValue >>= repeatBits - scaleBits;
+    }
+    while (repeatValue) {
+        scaled |= repeatValue;
+        repeatValue >>= repeatBits;
+    }
+    return scaled;
+}
+
+bool
+translateFromUMP(const quint32 *words, int count, QByteArray &message)
+{
+    message.resize(0);
+    if (count <= 0) {
+        return false;
+    }
+    quint32 word = words[0];
+    quint8 type = static_cast<quint8>(word >> 28);
+    if ((type == 0x1) || (type == 0x2)) {
+        quint8 status = static_cast<quint8>((word >> 16) & 0xff);
+        int length = getMessageLength(status);
+        if ((count != 1) || (! length) ||
+            ((type == 0x1) != (status >= 0xf0))) {
+            return false;
+        }
+        message.append(static_cast<char>(status));
+        if (length > 1) {
+            message.append(static_cast<char>((word >> 8) & 0x7f));
+        }
+        if (length > 2) {
+            message.append(static_cast<char>(word & 0x7f));
+        }
+        return true;
+    }
+    if (type != 0x3) {
+        return false;
+    }
+
+    // A system exclusive message is a single complete packet, or a start
+    // packet, any number of continue packets, and an end packet.
+    message.append(static_cast<char>(0xf0));
+    quint8 group = static_cast<quint8>((word >> 24) & 0xf);
+    for (int i = 0; i < count; i += 2) {
+        if ((i + 1) == count) {
+            return false;
+        }
+        word = words[i];
+        if (((word >> 28) != 0x3) || (((word >> 24) & 0xf) != group)) {
+            return false;
+        }
+        int status = static_cast<int>((word >> 20) & 0xf);
+        int expected;
+        if (! i) {
+            expected = (count == 2) ? SYSEXPACKETSTATUS_COMPLETE :
+                SYSEXPACKETSTATUS_START;
+        } else {
+            expected = ((i + 2) == count) ? SYSEXPACKETSTATUS_END :
+                SYSEXPACKETSTATUS_CONTINUE;
+        }
+        int byteCount = static_cast<int>((word >> 16) & 0xf);
+        if ((status != expected) || (byteCount > 6)) {
+            return false;
+        }
+        quint8 bytes[6] = {
+            static_cast<quint8>((word >> 8) & 0xff),
+            static_cast<quint8>(word & 0xff),
+            static_cast<quint8>(words[i + 1] >> 24),
+            static_cast<quint8>((words[i + 1] >> 16) & 0xff),
+            static_cast<quint8>((words[i + 1] >> 8) & 0xff),
+            static_cast<quint8>(words[i + 1] & 0xff)
+        };
+        for (int j = 0; j < byteCount; j++) {
+            if (bytes[j] & 0x80) {
+                return false;
+            }
+        }
+        message.append(reinterpret_cast<const char *>(bytes), byteCount);
+    }
+    message.append(static_cast<char>(0xf7));
+    return true;
+}
+
+bool
+translateToMIDI2(quint32 word, quint32 *midi2Words)
+{
+    if ((word >> 28) != 0x2) {
+        return false;
+    }
+    quint32 header = (0x4U << 28) | (word & 0x0fff0000);
+    quint32 status = (word >> 20) & 0xf;
+    quint32 number = (word >> 8) & 0x7f;
+    quint32 value = word & 0x7f;
+    switch (status) {
+    case 0x8:
+    case 0x9:
+
+        // A note on with a velocity of zero is a note off.
+        if ((status == 0x9) && (! value)) {
+            header = (header & 0xff0fffff) | (0x8 << 20);
+        }
+        midi2Words[0] = header | (number << 8);
+        midi2Words[1] = scaleUp(value, 7, 16) << 16;
+        return true;
+    case 0xa:
+    case 0xb:
+        midi2Words[0] = header | (number << 8);
+        midi2Words[1] = scaleUp(value, 7, 32);
+        return true;
+    case 0xc:
+        midi2Words[0] = header;
+        midi2Words[1] = number << 24;
+        return true;
+    case 0xd:
+        midi2Words[0] = header;
+        midi2Words[1] = scaleUp(number, 7, 32);
+        return true;
+    case 0xe:
+        midi2Words[0] = header;
+        midi2Words[1] = scaleUp(number | (value << 7), 14, 32);
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool
+translateToUMP(const quint8 *message, quint32 length, quint8 group,
+               QVector<quint32> &words)
+{
+    if (! decodeMessage(message, length).isValid()) {
+        return false;
+    }
+    quint32 header = static_cast<quint32>(group & 0xf) << 24;
+    quint8 status = message[0];
+    if (status != 0xf0) {
+        quint32 word = header | (status << 16);
+        word |= (status < 0xf0) ? (0x2U << 28) : (0x1U << 28);
+        if (length > 1) {
+            word |= message[1] << 8;
+        }
+        if (length > 2) {
+            word |= message[2];
+        }
+        words.append(word);
+        return true;
+    }
+
+    // System exclusive data is split into packets of up to six bytes,
+    // without the status and end bytes.
+    const quint8 *data = message + 1;
+    quint32 remaining = length - 2;
+    bool first = true;
+    header |= 0x3U << 28;
+    do {
+        quint32 count = qMin(remaining, static_cast<quint32>(6));
+        quint32 status;
+        if (first) {
+            status = (count == remaining) ? SYSEXPACKETSTATUS_COMPLETE :
+                SYSEXPACKETSTATUS_START;
+        } else {
+            status = (count == remaining) ? SYSEXPACKETSTATUS_END :
+                SYSEXPACKETSTATUS_CONTINUE;
+        }
+        quint8 bytes[6] = { 0, 0, 0, 0, 0, 0 };
+        for (quint32 i = 0; i < count; i++) {
+            bytes[i] = data[i];
+        }
+        words.append(header | (status << 20) | (count << 16) |
+                     (bytes[0] << 8) | bytes[1]);
+        words.append((static_cast<quint32>(bytes[2]) << 24) |
+                     (bytes[3] << 16) | (bytes[4] << 8) | bytes[5]);
+        data += count;
+        remaining -= count;
+        first = false;
+    } while (remaining);
+    return true;
+}
@@ -0,0 +1,59 @@
+/*
+ * midisnoop - MIDI monitor and prober
+ * Copyright (C) 2012 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __UMPTRANSLATOR_H__
+#define __UMPTRANSLATOR_H__
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+
+// Translation between MIDI 1.0 messages and Universal MIDI Packets (UMP).
+//
+// MIDI 1.0 messages map onto UMP system messages (message type 0x1), MIDI 1.0
+// channel voice messages (0x2) and 7-bit system exclusive packets (0x3)
+// without loss, so translating a message to UMP and back gives the original
+// bytes.  MIDI 1.0 channel voice packets can also be translated to MIDI 2.0
+// channel voice messages (0x4), with their values scaled up the way the
+// MIDI 2.0 specification describes.  Bank select, RPN and NRPN controller
+// messages are translated as plain control changes.
+
+// Scales `value` from `sourceBits` bits to `destinationBits` bits, so that
+// the minimum, centre and maximum values map onto each other.
+quint32
+scaleUp(quint32 value, int sourceBits, int destinationBits);
+
+// Translates the packets in `words` back to a single MIDI 1.0 message,
+// which is stored in `message`.  Returns false if the packets don't make up
+// exactly one MIDI 1.0 message.
+bool
+translateFromUMP(const quint32 *words, int count, QByteArray &message);
+
+// Translates a UMP MIDI 1.0 channel voice packet to a MIDI 2.0 channel voice
+// packet, which is stored in the two words at `midi2Words`.  Returns false
+// if `word` isn't a MIDI 1.0 channel voice packet.
+bool
+translateToMIDI2(quint32 word, quint32 *midi2Words);
+
+// Appends the packets for a MIDI 1.0 message to `words`.  Returns false, and
+// leaves `words` alone, if `message` isn't a valid MIDI 1.0 message.
+bool
+translateToUMP(const quint8 *message, quint32 length, quint8 group,
+               QVector<quint32> &words);
+
+#endif
@@ -33,12 +33,6 @@ getChild(const QObject *object, const QString &name=QString())
     return child;
 }
 
-QString
-getMIDIControlString(quint8 control);
-
-QString
-getMIDINoteString(quint8 note);
-
 QWidget *
 loadForm(const QString &path, QWidget *parent=0);
 
@@ -26,6 +26,7 @@ View::View(QWidget *rootWidget, QObject *parent):
     connect(&closeEventFilter, SIGNAL(closeRequest()),
             SIGNAL(closeRequest()));
     rootWidget->installEventFilter(&closeEventFilter);
+    rootWidget->installEventFilter(this);
     this->rootWidget = rootWidget;
 }
 
@@ -34,6 +35,35 @@ View::~View()
     delete rootWidget;
 }
 
+void
+View::changeEvent(QEvent */*event*/)
+{
+    // Empty
+}
+
+bool
+View::eventFilter(QObject *object, QEvent *event)
+{
+    if (object == rootWidget) {
+        switch (event->type()) {
+        case QEvent::ActivationChange:
+        case QEvent::EnabledChange:
+        case QEvent::FontChange:
+        case QEvent::LanguageChange:
+        case QEvent::LocaleChange:
+        case QEvent::PaletteChange:
+        case QEvent::StyleChange:
+        case QEvent::WindowStateChange:
+        case QEvent::WindowTitleChange:
+            changeEvent(event);
+            break;
+        default:
+            ;
+        }
+    }
+    return QObject::eventFilter(object, event);
+}
+
 const QWidget *
 View::getRootWidget() const
 {
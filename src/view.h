@@ -69,6 +69,14 @@ protected:
     virtual
     ~View();
 
+    // Called with the change events (see `QWidget::changeEvent`) that are
+    // sent to the root widget.
+    virtual void
+    changeEvent(QEvent *event);
+
+    bool
+    eventFilter(QObject *object, QEvent *event);
+
     const QWidget *
     getRootWidget() const;
 